@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Math.dir/include/math/geometry/GeometryCalculator.cpp.o"
+  "CMakeFiles/Math.dir/include/math/geometry/GeometryCalculator.cpp.o.d"
+  "libMath.a"
+  "libMath.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Math.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,27 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/bench/GeometryBench.cpp" "CMakeFiles/Math_Bench.dir/bench/GeometryBench.cpp.o" "gcc" "CMakeFiles/Math_Bench.dir/bench/GeometryBench.cpp.o.d"
+  "/root/repo/bench/KalmanBench.cpp" "CMakeFiles/Math_Bench.dir/bench/KalmanBench.cpp.o" "gcc" "CMakeFiles/Math_Bench.dir/bench/KalmanBench.cpp.o.d"
+  "/root/repo/bench/MathBench.cpp" "CMakeFiles/Math_Bench.dir/bench/MathBench.cpp.o" "gcc" "CMakeFiles/Math_Bench.dir/bench/MathBench.cpp.o.d"
+  "/root/repo/bench/OccupancyGridBench.cpp" "CMakeFiles/Math_Bench.dir/bench/OccupancyGridBench.cpp.o" "gcc" "CMakeFiles/Math_Bench.dir/bench/OccupancyGridBench.cpp.o.d"
+  "/root/repo/bench/RayPacketBench.cpp" "CMakeFiles/Math_Bench.dir/bench/RayPacketBench.cpp.o" "gcc" "CMakeFiles/Math_Bench.dir/bench/RayPacketBench.cpp.o.d"
+  "/root/repo/bench/ScanSimulatorBench.cpp" "CMakeFiles/Math_Bench.dir/bench/ScanSimulatorBench.cpp.o" "gcc" "CMakeFiles/Math_Bench.dir/bench/ScanSimulatorBench.cpp.o.d"
+  "/root/repo/bench/SegmentBVHBench.cpp" "CMakeFiles/Math_Bench.dir/bench/SegmentBVHBench.cpp.o" "gcc" "CMakeFiles/Math_Bench.dir/bench/SegmentBVHBench.cpp.o.d"
+  "/root/repo/bench/SegmentSweepBench.cpp" "CMakeFiles/Math_Bench.dir/bench/SegmentSweepBench.cpp.o" "gcc" "CMakeFiles/Math_Bench.dir/bench/SegmentSweepBench.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_rel/CMakeFiles/Math.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
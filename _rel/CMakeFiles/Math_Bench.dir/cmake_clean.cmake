@@ -0,0 +1,25 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Math_Bench.dir/bench/GeometryBench.cpp.o"
+  "CMakeFiles/Math_Bench.dir/bench/GeometryBench.cpp.o.d"
+  "CMakeFiles/Math_Bench.dir/bench/KalmanBench.cpp.o"
+  "CMakeFiles/Math_Bench.dir/bench/KalmanBench.cpp.o.d"
+  "CMakeFiles/Math_Bench.dir/bench/MathBench.cpp.o"
+  "CMakeFiles/Math_Bench.dir/bench/MathBench.cpp.o.d"
+  "CMakeFiles/Math_Bench.dir/bench/OccupancyGridBench.cpp.o"
+  "CMakeFiles/Math_Bench.dir/bench/OccupancyGridBench.cpp.o.d"
+  "CMakeFiles/Math_Bench.dir/bench/RayPacketBench.cpp.o"
+  "CMakeFiles/Math_Bench.dir/bench/RayPacketBench.cpp.o.d"
+  "CMakeFiles/Math_Bench.dir/bench/ScanSimulatorBench.cpp.o"
+  "CMakeFiles/Math_Bench.dir/bench/ScanSimulatorBench.cpp.o.d"
+  "CMakeFiles/Math_Bench.dir/bench/SegmentBVHBench.cpp.o"
+  "CMakeFiles/Math_Bench.dir/bench/SegmentBVHBench.cpp.o.d"
+  "CMakeFiles/Math_Bench.dir/bench/SegmentSweepBench.cpp.o"
+  "CMakeFiles/Math_Bench.dir/bench/SegmentSweepBench.cpp.o.d"
+  "Math_Bench"
+  "Math_Bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Math_Bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
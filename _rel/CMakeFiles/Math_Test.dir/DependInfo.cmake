@@ -0,0 +1,32 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/test/FrameTreeTest.cpp" "CMakeFiles/Math_Test.dir/test/FrameTreeTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/FrameTreeTest.cpp.o.d"
+  "/root/repo/test/GeometryCalculatorTest.cpp" "CMakeFiles/Math_Test.dir/test/GeometryCalculatorTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/GeometryCalculatorTest.cpp.o.d"
+  "/root/repo/test/KalmanTest.cpp" "CMakeFiles/Math_Test.dir/test/KalmanTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/KalmanTest.cpp.o.d"
+  "/root/repo/test/MathTest.cpp" "CMakeFiles/Math_Test.dir/test/MathTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/MathTest.cpp.o.d"
+  "/root/repo/test/OccupancyGridTest.cpp" "CMakeFiles/Math_Test.dir/test/OccupancyGridTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/OccupancyGridTest.cpp.o.d"
+  "/root/repo/test/RayPacketTest.cpp" "CMakeFiles/Math_Test.dir/test/RayPacketTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/RayPacketTest.cpp.o.d"
+  "/root/repo/test/RayTest.cpp" "CMakeFiles/Math_Test.dir/test/RayTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/RayTest.cpp.o.d"
+  "/root/repo/test/ReferenceFrameTest.cpp" "CMakeFiles/Math_Test.dir/test/ReferenceFrameTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/ReferenceFrameTest.cpp.o.d"
+  "/root/repo/test/ScanSimulatorTest.cpp" "CMakeFiles/Math_Test.dir/test/ScanSimulatorTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/ScanSimulatorTest.cpp.o.d"
+  "/root/repo/test/SegmentBVHTest.cpp" "CMakeFiles/Math_Test.dir/test/SegmentBVHTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/SegmentBVHTest.cpp.o.d"
+  "/root/repo/test/SegmentSweepTest.cpp" "CMakeFiles/Math_Test.dir/test/SegmentSweepTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/SegmentSweepTest.cpp.o.d"
+  "/root/repo/test/SpatialTreeTest.cpp" "CMakeFiles/Math_Test.dir/test/SpatialTreeTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/SpatialTreeTest.cpp.o.d"
+  "/root/repo/test/TrigTest.cpp" "CMakeFiles/Math_Test.dir/test/TrigTest.cpp.o" "gcc" "CMakeFiles/Math_Test.dir/test/TrigTest.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_rel/CMakeFiles/Math.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,35 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Math_Test.dir/test/FrameTreeTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/FrameTreeTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/GeometryCalculatorTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/GeometryCalculatorTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/KalmanTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/KalmanTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/MathTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/MathTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/OccupancyGridTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/OccupancyGridTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/RayPacketTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/RayPacketTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/RayTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/RayTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/ReferenceFrameTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/ReferenceFrameTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/ScanSimulatorTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/ScanSimulatorTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/SegmentBVHTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/SegmentBVHTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/SegmentSweepTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/SegmentSweepTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/SpatialTreeTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/SpatialTreeTest.cpp.o.d"
+  "CMakeFiles/Math_Test.dir/test/TrigTest.cpp.o"
+  "CMakeFiles/Math_Test.dir/test/TrigTest.cpp.o.d"
+  "Math_Test"
+  "Math_Test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Math_Test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,314 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/GeometryCalculator.hpp>
+#include <math/geometry/Ray.hpp>
+#include <math/geometry/ReferenceFrame.hpp>
+#include <math/geometry/SpatialTree.h>
+#include <memory>
+#include <vector>
+#include "benchmark/benchmark.h"
+
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * Random lines generated once, outside the timed loops, so the benchmarks
+ * only measure the geometry. Indexing wraps with POOL - 1.
+ */
+template<uint32_t DIM, class ValueType>
+struct Lines
+{
+	typedef Matrix<ValueType, DIM, 1> Vec;
+
+	static constexpr size_t POOL = 1024;
+
+	std::vector<Vec> p1, v1, p2, v2;
+
+	Lines()
+	{
+		for (size_t i = 0; i < POOL; ++i)
+		{
+			p1.push_back(Vec::Random());
+			v1.push_back(Vec::Random().normalized());
+			p2.push_back(Vec::Random());
+			v2.push_back(Vec::Random());
+		}
+	}
+};
+
+template<uint32_t DIM, class ValueType>
+static void Orthogonal(benchmark::State& state)
+{
+	Lines<DIM, ValueType> lines;
+	size_t                i = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(orthogonal(lines.v1[i]));
+		i = (i + 1) & (lines.POOL - 1);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+template<uint32_t DIM, class ValueType>
+static void Intersects(benchmark::State& state)
+{
+	Lines<DIM, ValueType> lines;
+	size_t                i = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(intersects(lines.p1[i], lines.v1[i],
+			lines.p2[i], lines.v2[i]));
+		i = (i + 1) & (lines.POOL - 1);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+template<uint32_t DIM, class ValueType>
+static void Distance(benchmark::State& state)
+{
+	Lines<DIM, ValueType> lines;
+	size_t                i = 0;
+	ValueType             result;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(distance(lines.p1[i], lines.v1[i],
+			lines.p2[i], lines.v2[i], result));
+		benchmark::DoNotOptimize(result);
+		i = (i + 1) & (lines.POOL - 1);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+template<uint32_t DIM, class ValueType>
+static void Intersection(benchmark::State& state)
+{
+	Lines<DIM, ValueType>                  lines;
+	size_t                                 i = 0;
+	typename Lines<DIM, ValueType>::Vec    result;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(intersection(lines.p1[i], lines.v1[i],
+			lines.p2[i], lines.v2[i], result));
+		benchmark::DoNotOptimize(result);
+		i = (i + 1) & (lines.POOL - 1);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+template<uint32_t DIM, class ValueType>
+static void IntersectionDistance(benchmark::State& state)
+{
+	Lines<DIM, ValueType>               lines;
+	size_t                              i = 0;
+	typename Lines<DIM, ValueType>::Vec result;
+	ValueType                           d1, d2;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(intersectionDistance(lines.p1[i],
+			lines.v1[i], lines.p2[i], lines.v2[i], result, d1, d2));
+		benchmark::DoNotOptimize(d1);
+		benchmark::DoNotOptimize(d2);
+		i = (i + 1) & (lines.POOL - 1);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+template<uint32_t DIM, class ValueType>
+static void RayDistance(benchmark::State& state)
+{
+	Lines<DIM, ValueType>                      lines;
+	std::vector<Ray<DIM, ValueType>>           rays;
+	std::vector<LineSegment<DIM, ValueType>>   segments;
+	for (size_t i = 0; i < lines.POOL; ++i)
+	{
+		rays.emplace_back(lines.p1[i], lines.v1[i]);
+		segments.emplace_back(lines.p2[i], lines.p2[i] + lines.v2[i]);
+	}
+
+	size_t    i = 0;
+	ValueType result;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(rays[i].distance(segments[i], result));
+		benchmark::DoNotOptimize(result);
+		i = (i + 1) & (lines.POOL - 1);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+template<uint32_t DIM, class ValueType>
+static void RayDistanceBlock(benchmark::State& state)
+{
+	Lines<DIM, ValueType>                    lines;
+	std::vector<LineSegment<DIM, ValueType>> segments;
+	for (size_t i = 0; i < lines.POOL; ++i)
+		segments.emplace_back(lines.p2[i], lines.p2[i] + lines.v2[i]);
+
+	const LineSegmentBlock<DIM, ValueType>      block(segments);
+	const Ray<DIM, ValueType>                   ray(lines.p1[0], lines.v1[0]);
+	typename Ray<DIM, ValueType>::Distances     distances(block.size());
+	typename Ray<DIM, ValueType>::Types         types(block.size());
+	for (auto _ : state)
+	{
+		ray.distance(block, distances, types);
+		benchmark::DoNotOptimize(distances.data());
+		benchmark::DoNotOptimize(types.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * block.size());
+}
+
+template<uint32_t DIM, class ValueType>
+static void SpatialTreeInsert(benchmark::State& state)
+{
+	typedef Matrix<ValueType, DIM, 1> Vec;
+
+	std::vector<Vec> points;
+	for (int64_t i = 0; i < state.range(0); ++i)
+		points.push_back(Vec::Random() * ValueType(.999));
+
+	SpatialTree<DIM, Vec, ValueType> tree(Vec::Constant(-1), 2);
+	tree.reserve(points.size());
+	for (auto _ : state)
+	{
+		tree.clear();
+		for (const Vec& point : points)
+			benchmark::DoNotOptimize(tree.insert(point));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Tracking range(0) points of which range(1) take a small step each frame,
+ * either by moving them in place or, with range(2) set, by rebuilding the
+ * tree.
+ */
+template<uint32_t DIM, class ValueType>
+static void SpatialTreeTrack(benchmark::State& state)
+{
+	typedef Matrix<ValueType, DIM, 1> Vec;
+
+	std::vector<Vec> points, steps;
+	for (int64_t i = 0; i < state.range(0); ++i)
+		points.push_back(Vec::Random() * ValueType(.9));
+	for (int64_t i = 0; i < state.range(1); ++i)
+		steps.push_back(Vec::Random() * ValueType(.01));
+
+	SpatialTree<DIM, Vec, ValueType> tree(Vec::Constant(-1), 2);
+	tree.build(points, 1);
+	const bool rebuild = state.range(2);
+	size_t     frame   = 0;
+	for (auto _ : state)
+	{
+		// Alternate directions so points stay where they started
+		const ValueType sign = frame++ & 1 ? -1 : 1;
+		for (size_t i = 0; i < steps.size(); ++i)
+		{
+			const size_t j = i * points.size() / steps.size();
+			points[j] += steps[i] * sign;
+			if (!rebuild)
+				tree.move(j, points[j]);
+		}
+		if (rebuild)
+			tree.build(points, 1);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+/**
+ * Builds a tree of range(0) points in tight clusters, then finds the 8
+ * nearest neighbours of points near the clusters, with leaf buckets of
+ * BUCKET points.
+ */
+template<uint32_t BUCKET>
+static void SpatialTreeClustered(benchmark::State& state)
+{
+	std::vector<Vector3d> points, queries;
+	for (int64_t i = 0; i < state.range(0); ++i)
+	{
+		if (i % 256 == 0)
+			queries.push_back(Vector3d::Random() * .9);
+		points.push_back(queries.back() + Vector3d::Random() * .001);
+	}
+
+	SpatialTree<3, Vector3d, double, BUCKET> tree(Vector3d::Constant(-1), 2);
+	std::vector<typename SpatialTree<3, Vector3d, double,
+		BUCKET>::Neighbour> neighbours;
+	for (auto _ : state)
+	{
+		tree.build(points, 1);
+		for (const Vector3d& query : queries)
+			benchmark::DoNotOptimize(tree.knn(query, 8, neighbours));
+	}
+	state.counters["nodes"] = tree.nodeCount();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * getOffsetFromWorld() of the leaf of a chain of range(0) frames. With
+ * range(1) set every frame is invalidated first, so the whole chain is
+ * recomposed, otherwise the cached offset is returned.
+ */
+template<uint32_t DIM, class ValueType>
+static void GetOffsetFromWorld(benchmark::State& state)
+{
+	typedef ReferenceFrame<DIM, ValueType> Frame;
+
+	std::vector<std::unique_ptr<Frame>> chain;
+	for (int64_t i = 0; i < state.range(0); ++i)
+	{
+		chain.emplace_back(new Frame(i ? chain.back().get() : nullptr));
+		chain.back()->setXOffset(1);
+	}
+
+	Frame&     leaf       = *chain.back();
+	const bool invalidate = state.range(1);
+	for (auto _ : state)
+	{
+		if (invalidate)
+			leaf.invalidate();
+		benchmark::DoNotOptimize(leaf.getOffsetFromWorld());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Registers name for every dimension and scalar type, each followed by the
+ * optional argument setup.
+ */
+#define GEOMETRY_BENCHMARK(name, ...) \
+	BENCHMARK_TEMPLATE(name, 2, float) __VA_ARGS__; \
+	BENCHMARK_TEMPLATE(name, 2, double) __VA_ARGS__; \
+	BENCHMARK_TEMPLATE(name, 3, float) __VA_ARGS__; \
+	BENCHMARK_TEMPLATE(name, 3, double) __VA_ARGS__; \
+	BENCHMARK_TEMPLATE(name, 4, float) __VA_ARGS__; \
+	BENCHMARK_TEMPLATE(name, 4, double) __VA_ARGS__
+
+GEOMETRY_BENCHMARK(Orthogonal);
+GEOMETRY_BENCHMARK(Intersects);
+GEOMETRY_BENCHMARK(Distance);
+GEOMETRY_BENCHMARK(Intersection);
+GEOMETRY_BENCHMARK(IntersectionDistance);
+GEOMETRY_BENCHMARK(RayDistance);
+GEOMETRY_BENCHMARK(SpatialTreeInsert, ->Arg(4096));
+GEOMETRY_BENCHMARK(GetOffsetFromWorld,
+	->ArgNames({"depth", "invalidate"})->ArgsProduct({{1, 4, 16, 64}, {0, 1}}));
+
+BENCHMARK_TEMPLATE(SpatialTreeTrack, 2, double)
+	->ArgNames({"points", "moved", "rebuild"})
+	->ArgsProduct({{65536}, {64, 1024}, {0, 1}});
+BENCHMARK_TEMPLATE(SpatialTreeTrack, 3, double)
+	->ArgNames({"points", "moved", "rebuild"})
+	->ArgsProduct({{65536}, {64, 1024}, {0, 1}});
+
+BENCHMARK_TEMPLATE(SpatialTreeClustered, 1)->Arg(65536);
+BENCHMARK_TEMPLATE(SpatialTreeClustered, 8)->Arg(65536);
+BENCHMARK_TEMPLATE(SpatialTreeClustered, 16)->Arg(65536);
+
+BENCHMARK_TEMPLATE(RayDistanceBlock, 2, float);
+BENCHMARK_TEMPLATE(RayDistanceBlock, 2, double);
+BENCHMARK_TEMPLATE(RayDistanceBlock, 3, float);
+BENCHMARK_TEMPLATE(RayDistanceBlock, 3, double);
@@ -0,0 +1,124 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/kalman.hpp>
+#include <vector>
+#include "benchmark/benchmark.h"
+
+using namespace flabs;
+using namespace Eigen;
+
+template<uint32_t StateDim, uint32_t MeasurementDim, class ValueType>
+static void KalmanPredictUpdate(benchmark::State& state)
+{
+	typedef kalman<StateDim, MeasurementDim, ValueType> Filter;
+
+	Filter filter;
+	filter.transition.setRandom();
+	filter.transition *= .5;
+	filter.transition.diagonal().setOnes();
+	filter.processNoise.setIdentity();
+	filter.processNoise *= 1e-3;
+	filter.observation.setRandom();
+
+	typename Filter::Measurement measurement =
+		Filter::Measurement::Random();
+	for (auto _ : state)
+	{
+		filter.predict();
+		benchmark::DoNotOptimize(filter.update(measurement));
+		benchmark::DoNotOptimize(filter.state);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(KalmanPredictUpdate, 2, 1, double);
+BENCHMARK_TEMPLATE(KalmanPredictUpdate, 4, 2, double);
+BENCHMARK_TEMPLATE(KalmanPredictUpdate, 6, 3, double);
+BENCHMARK_TEMPLATE(KalmanPredictUpdate, 4, 2, float);
+BENCHMARK_TEMPLATE(KalmanPredictUpdate, 6, 3, float);
+
+template<uint32_t StateDim, uint32_t MeasurementDim, class ValueType>
+static void KalmanFiltersPredictUpdate(benchmark::State& state)
+{
+	typedef kalman<StateDim, MeasurementDim, ValueType> Filter;
+
+	Filter filter;
+	filter.transition.diagonal().setOnes();
+	filter.processNoise.setIdentity();
+	filter.processNoise *= 1e-3;
+	filter.observation.setRandom();
+
+	std::vector<Filter>          filters(state.range(0), filter);
+	typename Filter::Measurement measurement =
+		Filter::Measurement::Random();
+	for (auto _ : state)
+	{
+		for (Filter& f : filters)
+		{
+			f.predict();
+			benchmark::DoNotOptimize(f.update(measurement));
+		}
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * filters.size());
+}
+
+template<uint32_t StateDim, uint32_t MeasurementDim, class ValueType>
+static void KalmanBankPredictUpdate(benchmark::State& state)
+{
+	typedef kalmanBank<StateDim, MeasurementDim, ValueType> Bank;
+
+	Bank bank(state.range(0));
+	bank.processNoise.setIdentity();
+	bank.processNoise *= 1e-3;
+	bank.observation.setRandom();
+
+	typename Bank::Measurements measurements =
+		Bank::Measurements::Random(bank.size(), MeasurementDim);
+	typename Bank::Mask         mask         =
+		Bank::Mask::Constant(bank.size(), true);
+	for (auto _ : state)
+	{
+		bank.predict(state.range(1)).update(measurements, mask,
+			state.range(1));
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * bank.size());
+}
+
+BENCHMARK_TEMPLATE(KalmanFiltersPredictUpdate, 4, 2, double)->Arg(4096);
+BENCHMARK_TEMPLATE(KalmanBankPredictUpdate, 4, 2, double)
+	->Args({4096, 1})->Args({4096, 0});
+BENCHMARK_TEMPLATE(KalmanFiltersPredictUpdate, 4, 2, float)->Arg(4096);
+BENCHMARK_TEMPLATE(KalmanBankPredictUpdate, 4, 2, float)
+	->Args({4096, 1})->Args({4096, 0});
+
+template<uint32_t StateDim, uint32_t MeasurementDim, class ValueType>
+static void SquareRootKalmanPredictUpdate(benchmark::State& state)
+{
+	typedef squareRootKalman<StateDim, MeasurementDim, ValueType> Filter;
+
+	Filter filter;
+	filter.transition.setRandom();
+	filter.transition *= .5;
+	filter.transition.diagonal().setOnes();
+	filter.processNoiseFactor.setIdentity();
+	filter.processNoiseFactor *= 1e-2;
+	filter.observation.setRandom();
+
+	typename Filter::Measurement measurement =
+		Filter::Measurement::Random();
+	for (auto _ : state)
+	{
+		filter.predict();
+		benchmark::DoNotOptimize(filter.update(measurement));
+		benchmark::DoNotOptimize(filter.state);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(SquareRootKalmanPredictUpdate, 4, 2, double);
+BENCHMARK_TEMPLATE(SquareRootKalmanPredictUpdate, 4, 2, float);
+BENCHMARK_TEMPLATE(SquareRootKalmanPredictUpdate, 6, 3, float);
@@ -0,0 +1,170 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/Math.hpp>
+#include <math/Trig.hpp>
+#include "benchmark/benchmark.h"
+
+using namespace flabs;
+using namespace Eigen;
+
+template<class ValueType>
+static void AngleDifferenceScalar(benchmark::State& state)
+{
+	typedef Array<ValueType, Dynamic, 1> Angles;
+
+	Angles a = Angles::Random(state.range(0)) * 10;
+	Angles b = Angles::Random(state.range(0)) * 10;
+	Angles r(state.range(0));
+	for (auto _ : state)
+	{
+		for (Index i = 0; i < r.size(); ++i)
+			r(i) = angleDifference(a(i), b(i));
+		benchmark::DoNotOptimize(r.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class ValueType>
+static void AngleDifferenceArray(benchmark::State& state)
+{
+	typedef Array<ValueType, Dynamic, 1> Angles;
+
+	Angles a = Angles::Random(state.range(0)) * 10;
+	Angles b = Angles::Random(state.range(0)) * 10;
+	Angles r(state.range(0));
+	for (auto _ : state)
+	{
+		r = angleDifference(a, b);
+		benchmark::DoNotOptimize(r.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class ValueType>
+static void IntervalDifferenceScalar(benchmark::State& state)
+{
+	typedef Array<ValueType, Dynamic, 1> Values;
+
+	Values a = Values::Random(state.range(0)) * 10;
+	Values b = Values::Random(state.range(0)) * 10;
+	Values r(state.range(0));
+	for (auto _ : state)
+	{
+		for (Index i = 0; i < r.size(); ++i)
+			r(i) = intervalDifference<ValueType>(a(i), b(i), -1, 1);
+		benchmark::DoNotOptimize(r.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class ValueType>
+static void IntervalDifferenceArray(benchmark::State& state)
+{
+	typedef Array<ValueType, Dynamic, 1> Values;
+
+	Values a = Values::Random(state.range(0)) * 10;
+	Values b = Values::Random(state.range(0)) * 10;
+	Values r(state.range(0));
+	for (auto _ : state)
+	{
+		r = intervalDifference(a, b, ValueType(-1), ValueType(1));
+		benchmark::DoNotOptimize(r.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(AngleDifferenceScalar, float)->Arg(4096);
+BENCHMARK_TEMPLATE(AngleDifferenceArray, float)->Arg(4096);
+BENCHMARK_TEMPLATE(AngleDifferenceScalar, double)->Arg(4096);
+BENCHMARK_TEMPLATE(AngleDifferenceArray, double)->Arg(4096);
+BENCHMARK_TEMPLATE(IntervalDifferenceScalar, float)->Arg(4096);
+BENCHMARK_TEMPLATE(IntervalDifferenceArray, float)->Arg(4096);
+BENCHMARK_TEMPLATE(IntervalDifferenceScalar, double)->Arg(4096);
+BENCHMARK_TEMPLATE(IntervalDifferenceArray, double)->Arg(4096);
+
+template<class Trig, class ValueType>
+static void SinCos(benchmark::State& state)
+{
+	typedef Array<ValueType, Dynamic, 1> Angles;
+
+	Angles angles = Angles::Random(state.range(0)) * 10;
+	Angles s(state.range(0)), c(state.range(0));
+	for (auto _ : state)
+	{
+		for (Index i = 0; i < angles.size(); ++i)
+			Trig::sincos(angles(i), s(i), c(i));
+		benchmark::DoNotOptimize(s.data());
+		benchmark::DoNotOptimize(c.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Trig, class ValueType>
+static void SinCosBatch(benchmark::State& state)
+{
+	typedef Array<ValueType, Dynamic, 1> Angles;
+
+	Angles angles = Angles::Random(state.range(0)) * 10;
+	Angles s(state.range(0)), c(state.range(0));
+	for (auto _ : state)
+	{
+		Trig::sincos(angles, s, c);
+		benchmark::DoNotOptimize(s.data());
+		benchmark::DoNotOptimize(c.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Trig, class ValueType>
+static void Atan2(benchmark::State& state)
+{
+	typedef Array<ValueType, Dynamic, 1> Values;
+
+	Values y = Values::Random(state.range(0));
+	Values x = Values::Random(state.range(0));
+	Values r(state.range(0));
+	for (auto _ : state)
+	{
+		for (Index i = 0; i < r.size(); ++i)
+			r(i) = Trig::atan2(y(i), x(i));
+		benchmark::DoNotOptimize(r.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<class Trig, class ValueType>
+static void Atan2Batch(benchmark::State& state)
+{
+	typedef Array<ValueType, Dynamic, 1> Values;
+
+	Values y = Values::Random(state.range(0));
+	Values x = Values::Random(state.range(0));
+	Values r(state.range(0));
+	for (auto _ : state)
+	{
+		r = Trig::atan2(y, x);
+		benchmark::DoNotOptimize(r.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(SinCos, ExactTrig, double)->Arg(4096);
+BENCHMARK_TEMPLATE(SinCos, FastTrig, double)->Arg(4096);
+BENCHMARK_TEMPLATE(SinCosBatch, ExactTrig, double)->Arg(4096);
+BENCHMARK_TEMPLATE(SinCosBatch, FastTrig, double)->Arg(4096);
+BENCHMARK_TEMPLATE(SinCosBatch, FastTrig, float)->Arg(4096);
+BENCHMARK_TEMPLATE(Atan2, ExactTrig, double)->Arg(4096);
+BENCHMARK_TEMPLATE(Atan2, FastTrig, double)->Arg(4096);
+BENCHMARK_TEMPLATE(Atan2Batch, ExactTrig, double)->Arg(4096);
+BENCHMARK_TEMPLATE(Atan2Batch, FastTrig, double)->Arg(4096);
+BENCHMARK_TEMPLATE(Atan2Batch, FastTrig, float)->Arg(4096);
@@ -0,0 +1,59 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/OccupancyGrid.hpp>
+#include <vector>
+#include "benchmark/benchmark.h"
+
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * Integrates SCANS scans of 1080 beams with ranges up to 30 into a 5 cm
+ * grid of 80 m, on range(0) threads. Thread count 0 integrates the beams
+ * one at a time without the per-thread tiles.
+ */
+static void Integrate(benchmark::State& state)
+{
+	static constexpr size_t SCANS = 8;
+	static constexpr size_t BEAMS = 1080;
+
+	std::srand(1);
+	std::vector<Ray2d>  rays;
+	std::vector<double> ranges;
+	for (size_t scan = 0; scan < SCANS; ++scan)
+	{
+		const Vector2d origin = Vector2d::Random() * 10;
+		for (size_t beam = 0; beam < BEAMS; ++beam)
+		{
+			const double angle = 3 * M_PI / 2 * beam / BEAMS - 3 * M_PI / 4;
+			rays.emplace_back(origin, Vector2d(std::cos(angle),
+				std::sin(angle)));
+			ranges.push_back((Vector2d::Random()(0) + 1) * 15);
+		}
+	}
+
+	OccupancyGrid2d grid(Vector2d::Constant(-40), OccupancyGrid2d::Cell(1600,
+		1600), .05);
+	size_t          cells = 0;
+	for (size_t i = 0; i < rays.size(); ++i)
+		cells += grid.traverse(rays[i], ranges[i], [](size_t, double,
+			double) {});
+
+	for (auto _ : state)
+	{
+		if (state.range(0) == 0)
+			for (size_t i = 0; i < rays.size(); ++i)
+				grid.integrate(rays[i], ranges[i], 30);
+		else
+			grid.integrate(rays, ranges, 30, state.range(0));
+		benchmark::ClobberMemory();
+	}
+	state.counters["cells"] = benchmark::Counter(
+		double(state.iterations() * cells), benchmark::Counter::kIsRate);
+	state.SetItemsProcessed(state.iterations() * rays.size());
+}
+
+BENCHMARK(Integrate)->ArgName("threads")->Arg(0)->RangeMultiplier(2)
+	->Range(1, 8)->UseRealTime();
@@ -0,0 +1,132 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/RayPacket.hpp>
+#include <math/geometry/SegmentBVH.hpp>
+#include <math/geometry/SpatialTree.h>
+#include <vector>
+#include "benchmark/benchmark.h"
+
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * A coherent scan: BEAMS rays fanning out evenly from the middle of a square
+ * of scattered walls or points.
+ */
+template<uint32_t DIM, class ValueType>
+struct Scan
+{
+	typedef Matrix<ValueType, DIM, 1> Vec;
+
+	static constexpr size_t    BEAMS = 1024;
+	static constexpr ValueType SIDE  = 64;
+
+	std::vector<LineSegment<DIM, ValueType>> segments;
+	std::vector<Vec>                         points;
+	std::vector<Ray<DIM, ValueType>>         rays;
+
+	Scan()
+	{
+		std::srand(1);
+		for (size_t i = 0; i < 4096; ++i)
+		{
+			Vec start = (Vec::Random() + Vec::Ones()) * (SIDE / 2);
+			segments.emplace_back(start, start + Vec::Random());
+			points.push_back(start);
+		}
+		for (size_t i = 0; i < BEAMS; ++i)
+		{
+			const ValueType angle = ValueType(2 * M_PI * i / BEAMS);
+			Vec             direction = Vec::Zero();
+			direction(0) = std::cos(angle);
+			direction(1) = std::sin(angle);
+			rays.emplace_back(Vec::Constant(SIDE / 2), direction);
+		}
+	}
+};
+
+template<class ValueType>
+static void BVHSingle(benchmark::State& state)
+{
+	Scan<2, ValueType>          scan;
+	SegmentBVH<2, ValueType>    bvh(scan.segments);
+	for (auto _ : state)
+		for (const Ray<2, ValueType>& ray : scan.rays)
+		{
+			uint32_t  id;
+			ValueType distance;
+			benchmark::DoNotOptimize(bvh.raycast(ray, id, distance));
+			benchmark::DoNotOptimize(distance);
+		}
+	state.SetItemsProcessed(state.iterations() * scan.BEAMS);
+}
+
+template<class ValueType, int WIDTH>
+static void BVHPacket(benchmark::State& state)
+{
+	typedef RayPacket<2, ValueType, WIDTH> Packet;
+
+	Scan<2, ValueType>          scan;
+	SegmentBVH<2, ValueType>    bvh(scan.segments);
+	std::vector<Packet>         packets;
+	for (size_t i = 0; i < scan.BEAMS; i += WIDTH)
+		packets.emplace_back(&scan.rays[i], WIDTH);
+
+	typename Packet::Indices ids;
+	typename Packet::Lanes   distances;
+	for (auto _ : state)
+		for (const Packet& packet : packets)
+		{
+			bvh.raycast(packet, ids, distances);
+			benchmark::DoNotOptimize(distances.data());
+		}
+	state.SetItemsProcessed(state.iterations() * scan.BEAMS);
+}
+
+static void SpatialTreeSingle(benchmark::State& state)
+{
+	Scan<3, double>                  scan;
+	SpatialTree<3, Vector3d, double> tree(Vector3d::Zero(), scan.SIDE);
+	tree.build(scan.points);
+	for (auto _ : state)
+		for (const Ray3d& ray : scan.rays)
+		{
+			const Vector3d* element;
+			double          distance;
+			benchmark::DoNotOptimize(tree.raycast(ray, .5, element, distance));
+			benchmark::DoNotOptimize(distance);
+		}
+	state.SetItemsProcessed(state.iterations() * scan.BEAMS);
+}
+
+template<int WIDTH>
+static void SpatialTreePacket(benchmark::State& state)
+{
+	typedef RayPacket<3, double, WIDTH> Packet;
+
+	Scan<3, double>                  scan;
+	SpatialTree<3, Vector3d, double> tree(Vector3d::Zero(), scan.SIDE);
+	tree.build(scan.points);
+	std::vector<Packet> packets;
+	for (size_t i = 0; i < scan.BEAMS; i += WIDTH)
+		packets.emplace_back(&scan.rays[i], WIDTH);
+
+	const Vector3d*         elements[WIDTH];
+	typename Packet::Lanes  distances;
+	for (auto _ : state)
+		for (const Packet& packet : packets)
+			benchmark::DoNotOptimize(tree.raycast(packet, .5, elements,
+				distances));
+	state.SetItemsProcessed(state.iterations() * scan.BEAMS);
+}
+
+BENCHMARK_TEMPLATE(BVHSingle, double);
+BENCHMARK_TEMPLATE(BVHPacket, double, 4);
+BENCHMARK_TEMPLATE(BVHPacket, double, 8);
+BENCHMARK_TEMPLATE(BVHSingle, float);
+BENCHMARK_TEMPLATE(BVHPacket, float, 8);
+BENCHMARK(SpatialTreeSingle);
+BENCHMARK_TEMPLATE(SpatialTreePacket, 4);
+BENCHMARK_TEMPLATE(SpatialTreePacket, 8);
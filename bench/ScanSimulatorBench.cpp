@@ -0,0 +1,54 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/ReferenceFrame.hpp>
+#include <math/geometry/ScanSimulator.hpp>
+#include <vector>
+#include "benchmark/benchmark.h"
+
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * Batches of SCANS scans of a 1080 beam, 270 degree sensor in a map of 4096
+ * walls, on range(0) threads. The scans counter is in scans per second of
+ * wall clock time, to show how throughput scales with the thread count.
+ */
+static void Scan(benchmark::State& state)
+{
+	static constexpr size_t SCANS = 16;
+
+	std::srand(1);
+	std::vector<LineSegment2d> segments;
+	for (size_t i = 0; i < 4096; ++i)
+	{
+		Vector2d start = Vector2d::Random() * 32;
+		segments.emplace_back(start, start + Vector2d::Random());
+	}
+
+	ScanSimulator2d simulator(state.range(0));
+	simulator.setMap(segments);
+	simulator.setBeams(1080, -3 * M_PI / 4, 3 * M_PI / 4, 30);
+
+	std::vector<ReferenceFrame2d>        frames;
+	std::vector<const ReferenceFrame2d*> poses;
+	for (size_t i = 0; i < SCANS; ++i)
+		frames.emplace_back(Vector2d::Random()(0) * 30,
+			Vector2d::Random()(0) * 30, Vector2d::Random()(0) * M_PI);
+	for (const ReferenceFrame2d& frame : frames)
+		poses.push_back(&frame);
+
+	ScanSimulator2d::RangeMatrix ranges(simulator.beams(), SCANS);
+	for (auto _ : state)
+	{
+		simulator.scan(poses.data(), poses.size(), ranges);
+		benchmark::DoNotOptimize(ranges.data());
+	}
+	state.counters["scans"] = benchmark::Counter(
+		double(state.iterations() * SCANS), benchmark::Counter::kIsRate);
+	state.SetItemsProcessed(state.iterations() * SCANS * simulator.beams());
+}
+
+BENCHMARK(Scan)->ArgName("threads")->RangeMultiplier(2)->Range(1, 16)
+	->UseRealTime();
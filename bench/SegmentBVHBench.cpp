@@ -0,0 +1,95 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/SegmentBVH.hpp>
+#include <vector>
+#include "benchmark/benchmark.h"
+
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * range(0) walls of length up to 1 scattered over a square that grows with
+ * their number, and rays cast from inside it.
+ */
+struct Walls
+{
+	static constexpr size_t RAYS = 1024;
+
+	std::vector<LineSegment2d> segments;
+	std::vector<Ray2d>         rays;
+
+	explicit Walls(int64_t count)
+	{
+		std::srand(1);
+		const double side = std::sqrt(double(count));
+		for (int64_t i = 0; i < count; ++i)
+		{
+			Vector2d start = (Vector2d::Random() + Vector2d::Ones()) * side / 2;
+			segments.emplace_back(start, start + Vector2d::Random());
+		}
+		for (size_t i = 0; i < RAYS; ++i)
+			rays.emplace_back((Vector2d::Random() + Vector2d::Ones()) * side / 2,
+				Vector2d::Random().normalized());
+	}
+};
+
+static void Linear(benchmark::State& state)
+{
+	Walls  walls(state.range(0));
+	size_t i = 0;
+	for (auto _ : state)
+	{
+		double distance = std::numeric_limits<double>::infinity();
+		for (const LineSegment2d& segment : walls.segments)
+		{
+			double hit;
+			if (walls.rays[i].distance(segment, hit) == INTERSECT &&
+				hit < distance)
+				distance = hit;
+		}
+		benchmark::DoNotOptimize(distance);
+		i = (i + 1) & (walls.RAYS - 1);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void Raycast(benchmark::State& state)
+{
+	Walls        walls(state.range(0));
+	SegmentBVH2d bvh(walls.segments);
+	size_t       i = 0;
+	for (auto _ : state)
+	{
+		uint32_t id;
+		double   distance;
+		benchmark::DoNotOptimize(bvh.raycast(walls.rays[i], id, distance));
+		benchmark::DoNotOptimize(distance);
+		i = (i + 1) & (walls.RAYS - 1);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void Build(benchmark::State& state)
+{
+	Walls        walls(state.range(0));
+	SegmentBVH2d bvh;
+	for (auto _ : state)
+		bvh.build(walls.segments);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void Refit(benchmark::State& state)
+{
+	Walls        walls(state.range(0));
+	SegmentBVH2d bvh(walls.segments);
+	for (auto _ : state)
+		bvh.refit();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(Linear)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(Raycast)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(Build)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(Refit)->RangeMultiplier(8)->Range(64, 32768);
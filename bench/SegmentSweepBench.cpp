@@ -0,0 +1,55 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/SegmentSweep.hpp>
+#include <vector>
+#include "benchmark/benchmark.h"
+
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * range(0) segments of length up to 1 scattered over a square that grows
+ * with their number, so the count of intersections grows linearly.
+ */
+static std::vector<LineSegment2d> scatter(int64_t count)
+{
+	std::srand(1);
+	const double               side = std::sqrt(double(count));
+	std::vector<LineSegment2d> segments;
+	for (int64_t i = 0; i < count; ++i)
+	{
+		Vector2d start = (Vector2d::Random() + Vector2d::Ones()) * side / 2;
+		segments.emplace_back(start, start + Vector2d::Random());
+	}
+	return segments;
+}
+
+static void Sweep(benchmark::State& state)
+{
+	const std::vector<LineSegment2d> segments = scatter(state.range(0));
+	SegmentSweep<double>             sweep;
+	std::vector<SegmentPair>         pairs;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(sweep.find(segments, pairs));
+	state.counters["pairs"] = pairs.size();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetComplexityN(state.range(0));
+}
+
+static void BruteForce(benchmark::State& state)
+{
+	const std::vector<LineSegment2d> segments = scatter(state.range(0));
+	std::vector<SegmentPair>         pairs;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(intersectionsBruteForce(segments, pairs));
+	state.counters["pairs"] = pairs.size();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(Sweep)->RangeMultiplier(4)->Range(256, 16384)
+	->Complexity(benchmark::oNLogN);
+BENCHMARK(BruteForce)->RangeMultiplier(4)->Range(256, 4096)
+	->Complexity(benchmark::oNSquared);
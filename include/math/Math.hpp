@@ -6,10 +6,24 @@
 #define PROJECTS_MATH_HPP
 
 #include "geometry/Geometry.hpp"
+#include <type_traits>
+#include <Eigen/Eigen>
 #include <boost/math/constants/constants.hpp>
 
 namespace flabs
 {
+/**
+ * True for Eigen arrays and array expressions, which take the array overloads
+ * below instead of the scalar ones.
+ */
+template<class T>
+struct isEigenArray : std::is_base_of<Eigen::ArrayBase<T>, T>
+{
+};
+
+template<class T>
+using ifScalar = typename std::enable_if<!isEigenArray<T>::value, T>::type;
+
 /**
  * Computes a^2
  *
@@ -62,17 +76,42 @@ inline T hypot(const T t, const Args ... args)
  * @return
  */
 template<class T>
-inline T unsignedMod(T a, T b)
+inline ifScalar<T> unsignedMod(T a, T b)
 {
 	return a - floor(a / b) * b;
 }
 
+/**
+ * Computes the unsigned floating point remainder of each a / b
+ *
+ * @param a: the dividends
+ * @param b: the divisor
+ * @return the remainders [0, b)
+ */
+template<class Derived>
+inline typename Derived::PlainObject unsignedMod(
+	const Eigen::ArrayBase<Derived>& a, typename Derived::Scalar b)
+{
+	return a - (a / b).floor() * b;
+}
+
 template<class T>
-inline T zeroTo2Pi(T a)
+inline ifScalar<T> zeroTo2Pi(T a)
 {
 	return unsignedMod<T>(a, boost::math::constants::two_pi<T>());
 }
 
+/**
+ * Wraps each angle into [0, 2pi)
+ */
+template<class Derived>
+inline typename Derived::PlainObject zeroTo2Pi(
+	const Eigen::ArrayBase<Derived>& a)
+{
+	return unsignedMod(a,
+		boost::math::constants::two_pi<typename Derived::Scalar>());
+}
+
 /**
  * Computes the smallest difference between angles a and b within the range
  * [-pi, pi).
@@ -83,7 +122,7 @@ inline T zeroTo2Pi(T a)
  * @return a - b [-pi, pi)
  */
 template<class T>
-inline T angleDifference(T a, T b)
+inline ifScalar<T> angleDifference(T a, T b)
 {
 	a   = zeroTo2Pi<T>(a);
 	b   = zeroTo2Pi<T>(b);
@@ -95,6 +134,41 @@ inline T angleDifference(T a, T b)
 	return r;
 }
 
+/**
+ * Computes the smallest difference between each pair of angles a and b within
+ * the range [-pi, pi). The wrap is a select rather than a branch, so the
+ * whole computation vectorises, and each result equals the scalar
+ * angleDifference().
+ *
+ * @param a: first angles in radians
+ * @param b: second angles in radians, same size as a
+ * @return a - b [-pi, pi)
+ */
+template<class DerivedA, class DerivedB>
+inline typename DerivedA::PlainObject angleDifference(
+	const Eigen::ArrayBase<DerivedA>& a, const Eigen::ArrayBase<DerivedB>& b)
+{
+	typedef typename DerivedA::Scalar T;
+	const T pi    = boost::math::constants::pi<T>();
+	const T twoPi = boost::math::constants::two_pi<T>();
+
+	const typename DerivedA::PlainObject r = zeroTo2Pi(a) - zeroTo2Pi(b);
+	return (r >= pi).select(r - twoPi, (r < -pi).select(r + twoPi, r));
+}
+
+/**
+ * Computes count angle differences, see angleDifference(a, b).
+ *
+ * @param out: receives a - b, may alias a or b
+ */
+template<class T>
+inline void angleDifference(const T* a, const T* b, T* out, size_t count)
+{
+	typedef Eigen::Array<T, Eigen::Dynamic, 1> Array;
+	Eigen::Map<Array>(out, count) = angleDifference(
+		Eigen::Map<const Array>(a, count), Eigen::Map<const Array>(b, count));
+}
+
 /**
  * Computes the smallest difference between inputs a and b within the range
  * [min, max).
@@ -107,13 +181,31 @@ inline T angleDifference(T a, T b)
  * @return a - b [min, max)
  */
 template<class T>
-inline T intervalDifference(T a, T b, T min, T max)
+inline ifScalar<T> intervalDifference(T a, T b, T min, T max)
 {
 	T r = a - b;
 	r = unsignedMod<T>(r - min, max - min) + min;
 	return r;
 }
 
+/**
+ * Computes the smallest difference between each pair of inputs a and b
+ * within the range [min, max).
+ *
+ * @param a: first measures
+ * @param b: second measures, same size as a
+ * @param min: minimum of interval inclusive
+ * @param max: maximum of interval exclusive
+ * @return a - b [min, max)
+ */
+template<class DerivedA, class DerivedB>
+inline typename DerivedA::PlainObject intervalDifference(
+	const Eigen::ArrayBase<DerivedA>& a, const Eigen::ArrayBase<DerivedB>& b,
+	typename DerivedA::Scalar min, typename DerivedA::Scalar max)
+{
+	return unsignedMod(a - b - min, max - min) + min;
+}
+
 /**
  * Computes the smallest difference between inputs a and b within the range
  * [min, max).
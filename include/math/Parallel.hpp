@@ -0,0 +1,250 @@
+//
+// Created on 10/17/2026.
+//
+
+#ifndef PROJECTS_PARALLEL_HPP
+#define PROJECTS_PARALLEL_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace flabs
+{
+/**
+ * Computes how many threads to use for count items of work.
+ *
+ * @param threads: requested thread count, 0 for one per hardware thread
+ * @param count: the number of items to split
+ * @return a thread count in [1, max(count, 1)]
+ */
+inline unsigned threadCount(unsigned threads, size_t count)
+{
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	return (unsigned) std::max<size_t>(1, std::min<size_t>(threads, count));
+}
+
+/**
+ * Splits [0, count) into one contiguous chunk per thread and calls
+ * function(begin, end, thread) for each of them. Chunk 0 runs on the calling
+ * thread, and the call returns once every chunk has finished.
+ *
+ * @tparam Function: callable as void(size_t, size_t, unsigned)
+ * @param count: the number of items
+ * @param threads: the number of chunks, from threadCount()
+ * @param function: the work for one chunk
+ */
+template<class Function>
+inline void parallelFor(size_t count, unsigned threads, Function&& function)
+{
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	for (unsigned thread = 1; thread < threads; ++thread)
+		workers.emplace_back([&, thread]()
+		{
+			function(count * thread / threads, count * (thread + 1) / threads,
+				thread);
+		});
+	function(0, count / threads, 0);
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+/**
+ * A fixed set of threads that stay alive between jobs, for work that is
+ * repeated often enough that starting threads as parallelFor() does would
+ * cost more than the work itself. A job is split into chunks of grain items
+ * which the caller and the workers take from a shared atomic counter until
+ * none are left, so threads that finish early take over the chunks of slow
+ * ones.
+ *
+ * run() is not reentrant, one job runs at a time.
+ */
+class WorkerPool
+{
+public:
+	/**
+	 * @param threads: thread count including the caller of run(), 0 for one
+	 *        per hardware thread
+	 */
+	explicit WorkerPool(unsigned threads = 0)
+	{
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		workers.reserve(threads - 1);
+		for (unsigned thread = 1; thread < threads; ++thread)
+			workers.emplace_back([this, thread]()
+			{
+				work(thread);
+			});
+	}
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	/**
+	 * The number of threads that run a job, including the caller.
+	 */
+	inline unsigned size() const
+	{
+		return workers.size() + 1;
+	}
+
+	/**
+	 * Calls function(begin, end, thread) for consecutive chunks of [0, count)
+	 * of at most grain items, on this thread and every worker, and returns
+	 * once all of them have finished.
+	 *
+	 * @tparam Function: callable as void(size_t, size_t, unsigned)
+	 */
+	template<class Function>
+	void run(size_t count, size_t grain, Function&& function)
+	{
+		typedef typename std::remove_reference<Function>::type F;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			job     = const_cast<void*>(
+				static_cast<const void*>(std::addressof(function)));
+			invoke  = [](void* job, size_t begin, size_t end, unsigned thread)
+			{
+				(*static_cast<F*>(job))(begin, end, thread);
+			};
+			this->count = count;
+			this->grain = std::max<size_t>(1, grain);
+			next.store(0, std::memory_order_relaxed);
+			busy = workers.size();
+			++epoch;
+		}
+		wake.notify_all();
+
+		drain(0);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this]()
+		{
+			return busy == 0;
+		});
+	}
+
+private:
+	void drain(unsigned thread)
+	{
+		for (size_t begin; (begin = next.fetch_add(grain,
+			std::memory_order_relaxed)) < count;)
+			invoke(job, begin, std::min(count, begin + grain), thread);
+	}
+
+	void work(unsigned thread)
+	{
+		uint64_t seen = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&]()
+				{
+					return stopping || epoch != seen;
+				});
+				if (stopping)
+					return;
+				seen = epoch;
+			}
+
+			drain(thread);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--busy == 0)
+				done.notify_one();
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::mutex               mutex;
+	std::condition_variable  wake;
+	std::condition_variable  done;
+
+	void*  job = nullptr;
+	void   (*invoke)(void*, size_t, size_t, unsigned) = nullptr;
+	size_t count = 0;
+	size_t grain = 1;
+	std::atomic<size_t> next{0};
+	size_t   busy     = 0;
+	uint64_t epoch    = 0;
+	bool     stopping = false;
+};
+
+/**
+ * Stable least significant digit radix sort on the low bits of an unsigned
+ * key, 8 bits per pass. Each pass builds per-thread digit histograms and
+ * scatters every thread's chunk in parallel.
+ *
+ * @tparam T: the element type
+ * @tparam Key: callable as uint64_t(const T&)
+ * @param values: the elements to sort
+ * @param scratch: working storage, resized to values.size()
+ * @param bits: how many low bits of the key to sort on
+ * @param threads: thread count, from threadCount()
+ * @param key: extracts the key of an element
+ */
+template<class T, class Key>
+void radixSort(std::vector<T>& values, std::vector<T>& scratch, unsigned bits,
+	unsigned threads, Key&& key)
+{
+	const size_t RADIX = 256;
+	std::vector<size_t> histograms(RADIX * threads);
+	scratch.resize(values.size());
+
+	for (unsigned shift = 0; shift < bits; shift += 8)
+	{
+		std::fill(histograms.begin(), histograms.end(), 0);
+		parallelFor(values.size(), threads,
+			[&](size_t begin, size_t end, unsigned thread)
+			{
+				size_t* histogram = &histograms[RADIX * thread];
+				for (size_t i = begin; i < end; ++i)
+					++histogram[(key(values[i]) >> shift) & (RADIX - 1)];
+			});
+
+		size_t offset = 0;
+		for (size_t digit = 0; digit < RADIX; ++digit)
+			for (unsigned thread = 0; thread < threads; ++thread)
+			{
+				size_t& count = histograms[RADIX * thread + digit];
+				size_t  next  = offset + count;
+				count  = offset;
+				offset = next;
+			}
+
+		parallelFor(values.size(), threads,
+			[&](size_t begin, size_t end, unsigned thread)
+			{
+				size_t* offsets = &histograms[RADIX * thread];
+				for (size_t i = begin; i < end; ++i)
+					scratch[offsets[(key(values[i]) >> shift) &
+						(RADIX - 1)]++] = values[i];
+			});
+		values.swap(scratch);
+	}
+}
+}
+
+#endif //PROJECTS_PARALLEL_HPP
@@ -0,0 +1,198 @@
+//
+// Created on 10/17/2026.
+//
+
+#ifndef PROJECTS_TRIG_HPP
+#define PROJECTS_TRIG_HPP
+
+#include <cmath>
+#include <type_traits>
+#include <Eigen/Eigen>
+#include <boost/math/constants/constants.hpp>
+
+namespace flabs
+{
+template<class T>
+using ifArithmetic = typename std::enable_if<std::is_arithmetic<T>::value>::type;
+
+/**
+ * The scalar type of T, T itself for scalars and T::Scalar for Eigen types
+ */
+template<class T, class = void>
+struct scalarOf
+{
+	typedef T type;
+};
+
+template<class T>
+struct scalarOf<T, std::void_t<typename T::Scalar>>
+{
+	typedef typename T::Scalar type;
+};
+
+/**
+ * Trigonometry policy that forwards to the standard library. Each function
+ * also has a batch form over Eigen arrays.
+ */
+struct ExactTrig
+{
+	template<class T, class = ifArithmetic<T>>
+	static inline void sincos(T angle, T& sin, T& cos)
+	{
+		sin = std::sin(angle);
+		cos = std::cos(angle);
+	}
+
+	template<class T, class = ifArithmetic<T>>
+	static inline T atan2(T y, T x)
+	{
+		return std::atan2(y, x);
+	}
+
+	template<class Derived>
+	static inline void sincos(const Eigen::ArrayBase<Derived>& angles,
+		typename Derived::PlainObject& sin, typename Derived::PlainObject& cos)
+	{
+		sin = angles.sin();
+		cos = angles.cos();
+	}
+
+	template<class DerivedY, class DerivedX>
+	static inline typename DerivedY::PlainObject atan2(
+		const Eigen::ArrayBase<DerivedY>& y, const Eigen::ArrayBase<DerivedX>& x)
+	{
+		typedef typename DerivedY::Scalar T;
+		return y.binaryExpr(x, [](T y, T x)
+		{
+			return std::atan2(y, x);
+		});
+	}
+};
+
+/**
+ * Trigonometry policy built from polynomials, with no calls into libm.
+ *
+ * sincos() reduces the angle to [-pi/4, pi/4] around the nearest multiple of
+ * pi/2, evaluates sine and cosine together as Taylor polynomials of degree
+ * 13 and 12, and swaps and negates them by quadrant. The absolute error is
+ * below 1e-10 while |angle| < 1e5.
+ *
+ * atan2() evaluates an odd polynomial of degree 15, fitted to arctan on
+ * [0, 1], on the smaller over the larger of |x| and |y|, then reflects the
+ * result into the right octant. The absolute error is below 5e-8 rad.
+ *
+ * The batch forms do the reductions with select() instead of branches, so
+ * Eigen vectorises them.
+ */
+struct FastTrig
+{
+	template<class T, class = ifArithmetic<T>>
+	static inline void sincos(T angle, T& sin, T& cos)
+	{
+		const T q = std::floor(
+			angle * boost::math::constants::two_div_pi<T>() + T(.5));
+		T       s, c;
+		polynomials(reduce(angle, q), s, c);
+
+		const T quadrant = q - 4 * std::floor(q / 4);
+		const T swap     = quadrant == 1 || quadrant == 3;
+		sin = swap ? c : s;
+		cos = swap ? s : c;
+		if (quadrant >= 2)
+			sin = -sin;
+		if (quadrant == 1 || quadrant == 2)
+			cos = -cos;
+	}
+
+	template<class T, class = ifArithmetic<T>>
+	static inline T atan2(T y, T x)
+	{
+		const T ax = std::abs(x);
+		const T ay = std::abs(y);
+		const T mx = std::max(ax, ay);
+		T       r  = arctan(mx == 0 ? T(0) : std::min(ax, ay) / mx);
+		if (ay > ax)
+			r = boost::math::constants::half_pi<T>() - r;
+		if (x < 0)
+			r = boost::math::constants::pi<T>() - r;
+		return y < 0 ? -r : r;
+	}
+
+	template<class Derived>
+	static inline void sincos(const Eigen::ArrayBase<Derived>& angles,
+		typename Derived::PlainObject& sin, typename Derived::PlainObject& cos)
+	{
+		typedef typename Derived::Scalar      T;
+		typedef typename Derived::PlainObject Array;
+
+		const Array q = (angles *
+			boost::math::constants::two_div_pi<T>() + T(.5)).floor();
+		Array       s, c;
+		polynomials(Array(reduce(angles, q)), s, c);
+
+		const Array quadrant = q - T(4) * (q / T(4)).floor();
+		const auto  swap     = quadrant == T(1) || quadrant == T(3);
+		sin = swap.select(c, s);
+		cos = swap.select(s, c);
+		sin = (quadrant >= T(2)).select(-sin, sin);
+		cos = (quadrant == T(1) || quadrant == T(2)).select(-cos, cos);
+	}
+
+	template<class DerivedY, class DerivedX>
+	static inline typename DerivedY::PlainObject atan2(
+		const Eigen::ArrayBase<DerivedY>& y, const Eigen::ArrayBase<DerivedX>& x)
+	{
+		typedef typename DerivedY::Scalar      T;
+		typedef typename DerivedY::PlainObject Array;
+
+		const Array ax = x.abs();
+		const Array ay = y.abs();
+		const Array mx = ax.max(ay);
+		Array       r  = arctan(Array((mx == T(0)).select(T(0),
+			ax.min(ay) / mx)));
+		r = (ay > ax).select(boost::math::constants::half_pi<T>() - r, r);
+		r = (x < T(0)).select(boost::math::constants::pi<T>() - r, r);
+		return (y < T(0)).select(-r, r);
+	}
+
+private:
+	/**
+	 * angle - q pi/2, with pi/2 split into two parts so the product with q
+	 * stays exact.
+	 */
+	template<class T, class Q>
+	static inline auto reduce(const T& angle, const Q& q)
+	{
+		typedef typename scalarOf<Q>::type Real;
+		return angle - q * Real(1.57079632673412561417) -
+			q * Real(6.07710050650619224932e-11);
+	}
+
+	template<class T>
+	static inline void polynomials(const T& r, T& sin, T& cos)
+	{
+		typedef typename scalarOf<T>::type Real;
+		const T r2 = r * r;
+		sin = r + r * r2 * (Real(-1. / 6) + r2 * (Real(1. / 120) +
+			r2 * (Real(-1. / 5040) + r2 * (Real(1. / 362880) +
+			r2 * (Real(-1. / 39916800) + r2 * Real(1. / 6227020800))))));
+		cos = Real(1) + r2 * (Real(-1. / 2) + r2 * (Real(1. / 24) +
+			r2 * (Real(-1. / 720) + r2 * (Real(1. / 40320) +
+			r2 * (Real(-1. / 3628800) + r2 * Real(1. / 479001600))))));
+	}
+
+	template<class T>
+	static inline T arctan(const T& a)
+	{
+		typedef typename scalarOf<T>::type Real;
+		const T a2 = a * a;
+		return a * (Real(.99999943681033743) + a2 * (Real(-.33330106533557968) +
+			a2 * (Real(.19948507304038707) + a2 * (Real(-.13915793889010927) +
+			a2 * (Real(.096562354214987517) + a2 * (Real(-.056062895867529300) +
+			a2 * (Real(.021946421236673171) +
+			a2 * Real(-.0040732583452987399))))))));
+	}
+};
+}
+
+#endif //PROJECTS_TRIG_HPP
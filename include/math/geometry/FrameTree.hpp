@@ -0,0 +1,230 @@
+//
+// Created on 10/17/2026.
+//
+
+#ifndef PROJECTS_FRAMETREE_HPP
+#define PROJECTS_FRAMETREE_HPP
+
+#include <unordered_map>
+#include <vector>
+#include "../Parallel.hpp"
+#include "ReferenceFrame.hpp"
+
+namespace flabs
+{
+	/**
+	 * A tree of reference frames flattened into contiguous arrays. Frames are
+	 * stored parent before child, so every offset from world can be computed
+	 * in one linear sweep instead of one recursive walk per frame.
+	 */
+	template<uint32_t DIM, class ValueType = double,
+		class Storage = HomogeneousTransform<DIM, ValueType>>
+	class FrameTree
+	{
+		public:
+			typedef ReferenceFrame<DIM, ValueType, Storage> Ref;
+			typedef typename Ref::Vec                       Vec;
+			typedef typename Ref::Tran                      Tran;
+
+			static constexpr uint32_t NO_PARENT = 0xFFFFFFFF;
+
+		protected:
+			std::vector<uint32_t> parents;
+			std::vector<uint32_t> depths;
+			std::vector<Tran>     offsets;
+			std::vector<Tran>     offsetsFromWorld;
+
+			/**
+			 * Frame indices grouped by depth, and where each depth starts, for
+			 * the parallel sweep. Rebuilt after frames are added.
+			 */
+			std::vector<uint32_t> levelOrder;
+			std::vector<size_t>   levelStarts;
+
+		public:
+			FrameTree()
+			{
+			}
+
+			virtual ~FrameTree()
+			{
+			}
+
+			/**
+			 * Adds a frame. parent must already be in the tree, which keeps
+			 * the frames in parent before child order.
+			 *
+			 * @param offset: the offset from the parent frame
+			 * @param parent: index of the parent, NO_PARENT for a root
+			 * @return the index of the new frame
+			 */
+			uint32_t add(const Tran& offset, uint32_t parent = NO_PARENT)
+			{
+				const uint32_t index = parents.size();
+				parents.push_back(parent);
+				depths.push_back(parent == NO_PARENT ? 0 : depths[parent] + 1);
+				offsets.push_back(offset);
+				offsetsFromWorld.push_back(offset);
+				levelOrder.clear();
+				return index;
+			}
+
+			/**
+			 * Adds a copy of every frame, parents before children. A frame
+			 * whose parent is not among frames becomes a root holding its full
+			 * offset from world.
+			 *
+			 * @return the index in the tree of each frame, in the order given
+			 */
+			std::vector<uint32_t> add(const std::vector<const Ref*>& frames)
+			{
+				std::unordered_map<const Ref*, uint32_t> given;
+				for (uint32_t i = 0; i < frames.size(); ++i)
+					given[frames[i]] = i;
+
+				std::vector<uint32_t> indices(frames.size(), NO_PARENT);
+				for (uint32_t i = 0; i < frames.size(); ++i)
+					add(frames, given, indices, i);
+				return indices;
+			}
+
+			inline void setOffset(uint32_t frame, const Tran& offset)
+			{
+				offsets[frame] = offset;
+			}
+
+			inline const Tran& getOffset(uint32_t frame) const
+			{
+				return offsets[frame];
+			}
+
+			inline uint32_t getParent(uint32_t frame) const
+			{
+				return parents[frame];
+			}
+
+			/**
+			 * Returns the offset from world as of the last update().
+			 */
+			inline const Tran& getOffsetFromWorld(uint32_t frame) const
+			{
+				return offsetsFromWorld[frame];
+			}
+
+			inline Vec getWorldPosition(uint32_t frame) const
+			{
+				return offsetsFromWorld[frame].matrix()
+					.template block<DIM, 1>(0, DIM);
+			}
+
+			inline size_t size() const
+			{
+				return parents.size();
+			}
+
+			void reserve(size_t size)
+			{
+				parents.reserve(size);
+				depths.reserve(size);
+				offsets.reserve(size);
+				offsetsFromWorld.reserve(size);
+			}
+
+			void clear()
+			{
+				parents.clear();
+				depths.clear();
+				offsets.clear();
+				offsetsFromWorld.clear();
+				levelOrder.clear();
+			}
+
+			/**
+			 * Recomputes every offset from world. With one thread this is a
+			 * single sweep in storage order. With more, frames of the same
+			 * depth do not depend on each other, so each depth is swept in
+			 * parallel after the one above it.
+			 *
+			 * @param threads: thread count, 0 for one per hardware thread
+			 */
+			void update(unsigned threads = 1)
+			{
+				threads = threadCount(threads, size());
+				if (threads == 1)
+				{
+					for (size_t i = 0; i < size(); ++i)
+						updateFrame(i);
+					return;
+				}
+
+				if (levelOrder.size() != size())
+					buildLevels();
+
+				for (size_t level = 0; level + 1 < levelStarts.size(); ++level)
+				{
+					const uint32_t* frames = &levelOrder[levelStarts[level]];
+					const size_t    count  =
+										levelStarts[level + 1] - levelStarts[level];
+					parallelFor(count, threadCount(threads, count),
+						[&](size_t begin, size_t end, unsigned)
+						{
+							for (size_t i = begin; i < end; ++i)
+								updateFrame(frames[i]);
+						});
+				}
+			}
+
+		private:
+			inline void updateFrame(size_t frame)
+			{
+				if (parents[frame] == NO_PARENT)
+					offsetsFromWorld[frame] = offsets[frame];
+				else
+					offsetsFromWorld[frame] = Storage::compose(
+						offsetsFromWorld[parents[frame]], offsets[frame]);
+			}
+
+			void buildLevels()
+			{
+				uint32_t maxDepth = 0;
+				for (uint32_t depth : depths)
+					maxDepth = std::max(maxDepth, depth);
+
+				levelStarts.assign(maxDepth + 2, 0);
+				for (uint32_t depth : depths)
+					++levelStarts[depth + 1];
+				for (size_t level = 1; level < levelStarts.size(); ++level)
+					levelStarts[level] += levelStarts[level - 1];
+
+				std::vector<size_t> next(levelStarts.begin(),
+					levelStarts.end() - 1);
+				levelOrder.resize(size());
+				for (uint32_t i = 0; i < size(); ++i)
+					levelOrder[next[depths[i]]++] = i;
+			}
+
+			void add(const std::vector<const Ref*>& frames,
+				const std::unordered_map<const Ref*, uint32_t>& given,
+				std::vector<uint32_t>& indices, uint32_t i)
+			{
+				if (indices[i] != NO_PARENT)
+					return;
+
+				const Ref* frame  = frames[i];
+				auto       parent = given.find(frame->getParent());
+				if (parent == given.end())
+					indices[i] = add(frame->getOffsetFromWorld());
+				else
+				{
+					add(frames, given, indices, parent->second);
+					indices[i] = add(frame->transformationMatrix,
+						indices[parent->second]);
+				}
+			}
+	};
+
+	typedef FrameTree<2, double> FrameTree2d;
+	typedef FrameTree<3, double> FrameTree3d;
+}
+
+#endif //PROJECTS_FRAMETREE_HPP
@@ -23,56 +23,58 @@ namespace flabs
 	std::ostream&
 	operator<<(std::ostream& output, const IntersectionType& type);
 
-	template<class T>
-	inline T orthogonal2d(T v)
+	template<class Derived>
+	inline typename Derived::PlainObject
+	orthogonal2d(const Eigen::MatrixBase<Derived>& v)
 	{
-		std::swap(v(0, 0), v(1, 0));
-		v(0, 0) = -v(0, 0);
-		return v;
+		typename Derived::PlainObject normal;
+		normal(0, 0) = -v(1, 0);
+		normal(1, 0) = v(0, 0);
+		return normal;
 	}
 
-	template<class T>
-	inline T orthogonal3d(const T& v)
+	template<class Derived>
+	inline typename Derived::PlainObject
+	orthogonal3d(const Eigen::MatrixBase<Derived>& v)
 	{
-		T normal[2];
-		normal[0](0, 0) = -v(1, 0) - v(2, 0);
-		normal[0](1, 0) = v(0, 0);
-		normal[0](2, 0) = v(0, 0);
-		normal[1](0, 0) = -v(0, 0) - v(2, 0);
-		normal[1](1, 0) = v(1, 0);
-		normal[1](2, 0) = v(1, 0);
-		int select = v(1, 0) == 0 && v(0, 0) == -v(2, 0);
-		return normal[select];
+		const bool select = v(1, 0) == 0 && v(0, 0) == -v(2, 0);
+		typename Derived::PlainObject normal;
+		normal(0, 0) = select ? -v(0, 0) - v(2, 0) : -v(1, 0) - v(2, 0);
+		normal(1, 0) = select ? v(1, 0) : v(0, 0);
+		normal(2, 0) = normal(1, 0);
+		return normal;
 	}
 
-	//TODO: Templatize, so all dimensions are optimized at compile time.
-	template<class T, class Scalar = typename T::Scalar>
-	inline T orthogonal(const T& v,
+	/**
+	 * Calculates a vector orthogonal to v, picked at compile time for 2D, 3D
+	 * and N-D. In N-D every component is set to v(k), except component k,
+	 * which is set to minus the sum of the others. k is the first component
+	 * that is non-zero and leaves a non-zero sum, chosen with a select per
+	 * component instead of a search loop that breaks early. v may be any
+	 * Eigen expression or Map, it is read in place.
+	 */
+	template<class Derived, class Scalar = typename Derived::Scalar>
+	inline typename Derived::PlainObject
+	orthogonal(const Eigen::MatrixBase<Derived>& v,
 		Scalar tolerance = std::numeric_limits<Scalar>::epsilon() * 4)
 	{
-		if (T::RowsAtCompileTime == 2)
+		if constexpr (Derived::RowsAtCompileTime == 2)
 			return orthogonal2d(v);
-		else if (T::RowsAtCompileTime == 3)
+		else if constexpr (Derived::RowsAtCompileTime == 3)
 			return orthogonal3d(v);
 		else
 		{
-			T normal;
+			const Scalar total = v.sum();
+			Eigen::Index skip  = 0;
+			for (Eigen::Index i = v.rows(); i-- > 0;)
+				skip = v(i, 0) != 0 && total - v(i, 0) != 0 ? i : skip;
 
-			for (int skip = 0; skip < T::RowsAtCompileTime; ++skip)
-			{
-				Scalar   sum = 0;
-				for (int i   = 0; i < T::RowsAtCompileTime; ++i)
-				{
-					if (i != skip)
-					{
-						normal(i, 0) = v(skip, 0);
-						sum -= v(i, 0);
-					}
-				}
-				normal(skip, 0) = sum;
-				if (sum != 0 && v(skip, 0) != 0)
-					break;
-			}
+			typename Derived::PlainObject normal =
+				Derived::PlainObject::Constant(v.rows(), v(skip, 0));
+			Scalar sum = 0;
+			for (Eigen::Index i = 0; i < v.rows(); ++i)
+				sum -= i == skip ? Scalar(0) : v(i, 0);
+			normal(skip, 0) = sum;
 			return normal;
 		}
 	}
@@ -199,38 +201,40 @@ namespace flabs
 	 * because the distance is calculated as an intermediary
 	 * anyway, so if you wanted this distance, and did not use this function you
 	 * would have to calculate the distance again.
+	 *
+	 * Both distances come from closed forms, in 2D d2 = cross(v1, p2 - p1)
+	 * over the same denominator as d1, in N-D the projection of the
+	 * intersection onto the second line. Every output is written and the
+	 * result is picked with selects, so the kernel has no branches: parallel
+	 * lines give result = p1, and d1 = d2 = 0 if COINCIDENT, infinity if NONE.
 	 */
 	template<class T, class Scalar = typename T::Scalar>
-	IntersectionType
+	inline IntersectionType
 	intersectionDistance(T const& p1, T const& v1, T const& p2, T const& v2, T& result, Scalar& d1,
 		Scalar& d2,
 		Scalar tolerance = std::numeric_limits<Scalar>::epsilon() * 4)
 	{
-		T      n2          = orthogonal(v2);
-		Scalar denominator = v1.dot(n2);
-		Scalar numerator   = (p2 - p1).dot(n2);
+		const T      w           = p2 - p1;
+		const T      n2          = orthogonal(v2);
+		const Scalar denominator = v1.dot(n2);
+		const Scalar numerator   = w.dot(n2);
+		const bool   parallel    = std::abs(denominator) <= tolerance;
+		const bool   coincident  = parallel && std::abs(numerator) <= tolerance;
+		const Scalar miss        = coincident ? Scalar(0) :
+								   std::numeric_limits<Scalar>::infinity();
 
-		if (std::abs(denominator) <= tolerance)
-		{
-			if (std::abs(numerator) <= tolerance)
-			{
-				d1 = d2 = 0;
-				return COINCIDENT;
-			}
-			else
-				return NONE;
-		}
+		const Scalar distance = parallel ? Scalar(0) : numerator / denominator;
+		Scalar       distance2;
+		if constexpr (T::RowsAtCompileTime == 2)
+			distance2 = (v1(0) * w(1) - v1(1) * w(0)) / denominator;
+		else
+			distance2 = (v1 * distance - w).dot(v2) / v2.squaredNorm();
 
-		d1     = numerator / denominator;
-		result = p1 + v1 * d1;
-		//TODO: No branch option
-		for (uint32_t i = 0; i < T::RowsAtCompileTime; ++i)
-			if (v2(i) != 0)
-			{
-				d2 = (result(i) - p2(i)) / v2(i);
-				break;
-			}
-		return INTERSECT;
+		result = p1 + v1 * distance;
+		d1     = parallel ? miss : distance;
+		d2     = parallel ? miss : distance2;
+		return IntersectionType(int(!parallel) * INTERSECT +
+			int(coincident) * COINCIDENT);
 	}
 
 //	/**
@@ -0,0 +1,90 @@
+/*
+ * LineSegmentBlock.hpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef LINESEGMENTBLOCK_H_
+#define LINESEGMENTBLOCK_H_
+
+#include <vector>
+#include "LineSegment.hpp"
+
+namespace flabs
+{
+	/**
+	 * A structure-of-arrays block of line segments. Each column of start and
+	 * extends holds one component of every segment contiguously, so batch
+	 * kernels can process a whole component at a time in SIMD lanes.
+	 */
+	template<uint32_t DIM, typename ValueType = double>
+	class LineSegmentBlock
+	{
+		private:
+			typedef LineSegmentBlock<DIM, ValueType> Blk;
+			typedef LineSegment<DIM, ValueType>      Seg;
+
+		public:
+			typedef Eigen::Array<ValueType, Eigen::Dynamic, DIM> Components;
+
+		public:
+			Components start;
+			Components extends;
+
+		public:
+			LineSegmentBlock()
+			{
+			}
+
+			explicit LineSegmentBlock(Eigen::Index size) : start(size, DIM),
+				extends(size, DIM)
+			{
+			}
+
+			LineSegmentBlock(const std::vector<Seg>& segments) :
+				start(segments.size(), DIM), extends(segments.size(), DIM)
+			{
+				for (Eigen::Index i = 0; i < size(); ++i)
+					set(i, segments[i]);
+			}
+
+			LineSegmentBlock(const Blk& block) : start(block.start),
+				extends(block.extends)
+			{
+			}
+
+			~LineSegmentBlock()
+			{
+			}
+
+			inline Eigen::Index size() const
+			{
+				return start.rows();
+			}
+
+			inline void resize(Eigen::Index size)
+			{
+				start.resize(size, DIM);
+				extends.resize(size, DIM);
+			}
+
+			inline void set(Eigen::Index i, const Seg& segment)
+			{
+				start.row(i)   = segment.start.transpose().array();
+				extends.row(i) = segment.extends.transpose().array();
+			}
+
+			inline Seg get(Eigen::Index i) const
+			{
+				Seg segment;
+				segment.start   = start.row(i).transpose().matrix();
+				segment.extends = extends.row(i).transpose().matrix();
+				return segment;
+			}
+	};
+
+	typedef LineSegmentBlock<2> LineSegmentBlock2d;
+	typedef LineSegmentBlock<3> LineSegmentBlock3d;
+}
+
+#endif
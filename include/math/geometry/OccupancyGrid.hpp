@@ -0,0 +1,370 @@
+//
+// Created on 10/17/2026.
+//
+
+#ifndef PROJECTS_OCCUPANCYGRID_HPP
+#define PROJECTS_OCCUPANCYGRID_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "../Parallel.hpp"
+#include "Ray.hpp"
+
+namespace flabs
+{
+	/**
+	 * A DIM dimensional occupancy grid of log-odds, updated by marching
+	 * sensor rays through it.
+	 *
+	 * Cells are stored in tiles of 2^TILE_BITS cells per side, each tile
+	 * contiguous, so a ray stays within a few cache lines for longer than in
+	 * a row major layout, and tiles are the unit threads accumulate into.
+	 *
+	 * traverse() walks the cells a ray passes through with the Amanatides-Woo
+	 * algorithm: per axis it tracks the distance along the ray to the next
+	 * cell boundary, and steps across whichever boundary is nearest, so every
+	 * cell is visited once in order with no sampling.
+	 */
+	template<uint32_t DIM, typename ValueType = double, uint32_t TILE_BITS = 3>
+	class OccupancyGrid
+	{
+		public:
+			typedef Vector<DIM, ValueType>           Vec;
+			typedef Eigen::Matrix<int64_t, DIM, 1>   Cell;
+			typedef Ray<DIM, ValueType>              Ry;
+			typedef float                            LogOdds;
+
+			static constexpr uint32_t TILE       = 1 << TILE_BITS;
+			static constexpr uint32_t TILE_CELLS = 1 << (TILE_BITS * DIM);
+
+		protected:
+			/**
+			 * The updates of one thread, kept per tile so only tiles the
+			 * thread touched need to be merged.
+			 */
+			struct Scratch
+			{
+				std::vector<int32_t> slots;
+				std::vector<size_t>  tiles;
+				std::vector<LogOdds> deltas;
+			};
+
+			Vec                  corner;
+			ValueType            resolution;
+			Cell                 size;
+			Cell                 tileCounts;
+			std::vector<LogOdds> cells;
+			std::vector<Scratch> scratch;
+
+			LogOdds hitLogOdds  = LogOdds(.85);
+			LogOdds missLogOdds = LogOdds(-.4);
+			LogOdds minLogOdds  = LogOdds(-2);
+			LogOdds maxLogOdds  = LogOdds(3.5);
+
+		public:
+			/**
+			 * @param corner: the lowest corner of cell 0
+			 * @param size: the number of cells along each axis
+			 * @param resolution: the side of a cell
+			 */
+			OccupancyGrid(const Vec& corner, const Cell& size,
+				ValueType resolution) : corner(corner), resolution(resolution),
+				size(size)
+			{
+				tileCounts = (size.array() + TILE - 1) / TILE;
+				cells.assign(tileCounts.prod() * TILE_CELLS, 0);
+			}
+
+			virtual ~OccupancyGrid()
+			{
+			}
+
+			/**
+			 * Sets the log-odds added for a hit and for a miss, and the range
+			 * cells are clamped to.
+			 */
+			inline void setLogOdds(LogOdds hit, LogOdds miss, LogOdds min,
+				LogOdds max)
+			{
+				hitLogOdds  = hit;
+				missLogOdds = miss;
+				minLogOdds  = min;
+				maxLogOdds  = max;
+			}
+
+			inline const Cell& getSize() const
+			{
+				return size;
+			}
+
+			inline ValueType getResolution() const
+			{
+				return resolution;
+			}
+
+			inline void clear()
+			{
+				std::fill(cells.begin(), cells.end(), 0);
+			}
+
+			/**
+			 * Finds the cell containing point.
+			 *
+			 * @return false if the point is outside the grid
+			 */
+			inline bool cell(const Vec& point, Cell& cell) const
+			{
+				for (uint32_t i = 0; i < DIM; ++i)
+				{
+					const ValueType c = std::floor((point[i] - corner[i]) /
+						resolution);
+					if (!(c >= 0 && c < size[i]))
+						return false;
+					cell[i] = int64_t(c);
+				}
+				return true;
+			}
+
+			/**
+			 * The position of cell in the storage.
+			 */
+			inline size_t index(const Cell& cell) const
+			{
+				size_t tile  = 0;
+				size_t local = 0;
+				for (uint32_t i = DIM; i-- > 0;)
+				{
+					tile  = tile * tileCounts[i] + (cell[i] >> TILE_BITS);
+					local = (local << TILE_BITS) | (cell[i] & (TILE - 1));
+				}
+				return tile * TILE_CELLS + local;
+			}
+
+			inline LogOdds logOdds(const Cell& cell) const
+			{
+				return cells[index(cell)];
+			}
+
+			inline ValueType probability(const Cell& cell) const
+			{
+				return 1 - 1 / (1 + std::exp(ValueType(logOdds(cell))));
+			}
+
+			/**
+			 * Visits the cells ray passes through, from its start up to
+			 * length, in order. The part of the ray outside the grid is
+			 * skipped.
+			 *
+			 * @param visit: functor void(size_t index, ValueType enter,
+			 *        ValueType exit) called with each cell's index() and the
+			 *        distances along the ray where it enters and leaves it
+			 * @return the number of cells visited
+			 */
+			template<class Visit>
+			size_t traverse(const Ry& ray, ValueType length,
+				Visit&& visit) const
+			{
+				// Clip the ray to the grid
+				const Vec& direction = ray.normalizedDirection;
+				ValueType  enter     = 0;
+				ValueType  exit      = length;
+				for (uint32_t i = 0; i < DIM; ++i)
+				{
+					const ValueType inverse = 1 / direction[i];
+					const ValueType t1 = (corner[i] - ray.start[i]) * inverse;
+					const ValueType t2 = (corner[i] + size[i] * resolution -
+						ray.start[i]) * inverse;
+					enter = std::max(enter, std::min(t1, t2));
+					exit  = std::min(exit, std::max(t1, t2));
+				}
+				if (!(enter <= exit))
+					return 0;
+
+				Cell      cell, step;
+				Vec       next, delta;
+				const Vec first = ray.start + direction * enter;
+				for (uint32_t i = 0; i < DIM; ++i)
+				{
+					cell[i] = std::min<int64_t>(size[i] - 1, std::max<int64_t>(0,
+						int64_t(std::floor((first[i] - corner[i]) /
+						resolution))));
+					if (direction[i] > 0)
+					{
+						step[i]  = 1;
+						next[i]  = (corner[i] + (cell[i] + 1) * resolution -
+							ray.start[i]) / direction[i];
+						delta[i] = resolution / direction[i];
+					}
+					else if (direction[i] < 0)
+					{
+						step[i]  = -1;
+						next[i]  = (corner[i] + cell[i] * resolution -
+							ray.start[i]) / direction[i];
+						delta[i] = -resolution / direction[i];
+					}
+					else
+					{
+						step[i]  = 0;
+						next[i]  = std::numeric_limits<ValueType>::infinity();
+						delta[i] = 0;
+					}
+				}
+
+				size_t visited = 0;
+				while (true)
+				{
+					uint32_t axis;
+					next.minCoeff(&axis);
+					const ValueType leave = std::min(next[axis], exit);
+					visit(index(cell), enter, leave);
+					++visited;
+
+					if (next[axis] >= exit)
+						break;
+					cell[axis] += step[axis];
+					if (cell[axis] < 0 || cell[axis] >= size[axis])
+						break;
+					enter = next[axis];
+					next[axis] += delta[axis];
+				}
+				return visited;
+			}
+
+			/**
+			 * Integrates one beam: the cells it passes through are free,
+			 * and the cell it ends in is occupied unless range reached
+			 * maxRange, which means nothing was hit.
+			 */
+			void integrate(const Ry& ray, ValueType range, ValueType maxRange)
+			{
+				apply(ray, range, maxRange, [&](size_t index, LogOdds update)
+				{
+					cells[index] = std::min(maxLogOdds, std::max(minLogOdds,
+						cells[index] + update));
+				});
+			}
+
+			/**
+			 * Integrates many beams across threads. Each thread adds its
+			 * updates into private copies of the tiles it touches, and the
+			 * copies are then summed into the grid tile by tile, also in
+			 * parallel. Cells are clamped once after the sum, so the result
+			 * matches integrating the beams one at a time as long as no cell
+			 * reaches the clamp range midway. With one thread the beams are
+			 * integrated straight into the grid.
+			 *
+			 * @param rays: the beams
+			 * @param ranges: the measured range of each beam
+			 * @param maxRange: the range reported when nothing was hit
+			 * @param threads: thread count, 0 for one per hardware thread
+			 */
+			void integrate(const std::vector<Ry>& rays,
+				const std::vector<ValueType>& ranges, ValueType maxRange,
+				unsigned threads = 0)
+			{
+				const size_t tileCount = cells.size() / TILE_CELLS;
+				threads = threadCount(threads, rays.size());
+				if (threads == 1)
+				{
+					for (size_t i = 0; i < rays.size(); ++i)
+						integrate(rays[i], ranges[i], maxRange);
+					return;
+				}
+				if (scratch.size() < threads)
+					scratch.resize(threads);
+
+				parallelFor(rays.size(), threads,
+					[&](size_t begin, size_t end, unsigned thread)
+					{
+						Scratch& own = scratch[thread];
+						own.slots.resize(tileCount, -1);
+						for (size_t i = begin; i < end; ++i)
+							apply(rays[i], ranges[i], maxRange,
+								[&](size_t index, LogOdds update)
+								{
+									const size_t tile = index / TILE_CELLS;
+									int32_t&     slot = own.slots[tile];
+									if (slot < 0)
+									{
+										slot = own.tiles.size();
+										own.tiles.push_back(tile);
+										own.deltas.resize(own.deltas.size() +
+											TILE_CELLS, 0);
+									}
+									own.deltas[size_t(slot) * TILE_CELLS +
+										index % TILE_CELLS] += update;
+								});
+					});
+
+				parallelFor(tileCount, threadCount(threads, tileCount),
+					[&](size_t begin, size_t end, unsigned)
+					{
+						LogOdds sum[TILE_CELLS];
+						for (size_t tile = begin; tile < end; ++tile)
+						{
+							bool touched = false;
+							for (unsigned thread = 0; thread < threads; ++thread)
+							{
+								const int32_t slot = scratch[thread].slots[tile];
+								if (slot < 0)
+									continue;
+								const LogOdds* deltas = &scratch[thread].deltas[
+									size_t(slot) * TILE_CELLS];
+								if (!touched)
+									std::copy(deltas, deltas + TILE_CELLS, sum);
+								else
+									for (uint32_t i = 0; i < TILE_CELLS; ++i)
+										sum[i] += deltas[i];
+								touched = true;
+							}
+							if (!touched)
+								continue;
+							LogOdds* target = &cells[tile * TILE_CELLS];
+							for (uint32_t i = 0; i < TILE_CELLS; ++i)
+								target[i] = std::min(maxLogOdds, std::max(
+									minLogOdds, target[i] + sum[i]));
+						}
+					});
+
+				// Only the slots of touched tiles need resetting for next time
+				parallelFor(threads, threads,
+					[&](size_t begin, size_t end, unsigned)
+					{
+						for (size_t thread = begin; thread < end; ++thread)
+						{
+							Scratch& own = scratch[thread];
+							for (size_t tile : own.tiles)
+								own.slots[tile] = -1;
+							own.tiles.clear();
+							own.deltas.clear();
+						}
+					});
+			}
+
+		protected:
+			/**
+			 * Calls update(index, logOdds) for every cell a beam changes.
+			 */
+			template<class Update>
+			void apply(const Ry& ray, ValueType range, ValueType maxRange,
+				Update&& update) const
+			{
+				const bool      hit    = range < maxRange;
+				const ValueType length = std::min(range, maxRange);
+				traverse(ray, length,
+					[&](size_t index, ValueType, ValueType exit)
+					{
+						update(index, hit && exit >= length ? hitLogOdds :
+							missLogOdds);
+					});
+			}
+	};
+
+	typedef OccupancyGrid<2> OccupancyGrid2d;
+	typedef OccupancyGrid<3> OccupancyGrid3d;
+}
+
+#endif //PROJECTS_OCCUPANCYGRID_HPP
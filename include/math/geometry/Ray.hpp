@@ -10,6 +10,7 @@
 
 #include "GeometryCalculator.hpp"
 #include "LineSegment.hpp"
+#include "LineSegmentBlock.hpp"
 
 namespace flabs
 {
@@ -20,6 +21,15 @@ namespace flabs
 			typedef Ray<DIM, ValueType>              Ry;
 			typedef LineSegment<DIM, ValueType>      Seg;
 			typedef Vector<DIM, ValueType> Vec;
+			typedef LineSegmentBlock<DIM, ValueType> Blk;
+
+		public:
+			typedef Eigen::Array<ValueType, Eigen::Dynamic, 1> Distances;
+			typedef Eigen::Array<int, Eigen::Dynamic, 1>       Types;
+			typedef Eigen::Array<ValueType, Eigen::Dynamic, Eigen::Dynamic>
+				DistanceMatrix;
+			typedef Eigen::Array<int, Eigen::Dynamic, Eigen::Dynamic>
+				TypeMatrix;
 
 		public:
 			Vec start;
@@ -58,8 +68,106 @@ namespace flabs
 				else
 					return intersectionType;
 			}
+
+			/**
+			 * Batch form of distance(const LineSegment&, ValueType&). Tests
+			 * this ray against every segment in the block at once and writes,
+			 * per segment, the distance along the ray and the IntersectionType
+			 * code. The kernel is branch free, so misses are reported as NONE
+			 * with an infinite distance, and coincident segments as COINCIDENT
+			 * with a distance of 0.
+			 */
+			void distance(const Blk& segments, Eigen::Ref<Distances> distances,
+				Eigen::Ref<Types> types, ValueType tolerance =
+				std::numeric_limits<ValueType>::epsilon() * 4) const
+			{
+				static_assert(DIM == 2 || DIM == 3,
+					"Batch ray distance is only implemented for 2D and 3D");
+
+				const auto& p = segments.start;
+				const auto& e = segments.extends;
+				const Vec&  r = normalizedDirection;
+
+				if constexpr (DIM == 2)
+				{
+					// n2 = orthogonal2d(extends) = (-e1, e0)
+					auto w0          = p.col(0) - start(0);
+					auto w1          = p.col(1) - start(1);
+					auto denominator = r(1) * e.col(0) - r(0) * e.col(1);
+					auto numerator   = w1 * e.col(0) - w0 * e.col(1);
+					auto d2          = (r(0) * w1 - r(1) * w0) / denominator;
+
+					distances = numerator / denominator;
+					classify(denominator, numerator, d2, distances, types,
+						tolerance);
+				}
+				else
+				{
+					// n2 = orthogonal3d(extends) = (a, b, b)
+					auto select      = e.col(1) == 0 && e.col(0) == -e.col(2);
+					auto a           = select.select(-e.col(0) - e.col(2),
+						-e.col(1) - e.col(2));
+					auto b           = select.select(e.col(1), e.col(0));
+					auto w0          = p.col(0) - start(0);
+					auto w1          = p.col(1) - start(1);
+					auto w2          = p.col(2) - start(2);
+					auto denominator = r(0) * a + (r(1) + r(2)) * b;
+					auto numerator   = w0 * a + (w1 + w2) * b;
+
+					distances = numerator / denominator;
+
+					// d2 is the projection of the intersection onto the segment
+					auto d2 = ((r(0) * distances - w0) * e.col(0) +
+						(r(1) * distances - w1) * e.col(1) +
+						(r(2) * distances - w2) * e.col(2)) /
+						e.matrix().rowwise().squaredNorm().array();
+					classify(denominator, numerator, d2, distances, types,
+						tolerance);
+				}
+			}
+
+		private:
+			/**
+			 * Turns the line-line terms of a batch into IntersectionType codes
+			 * and final distances. distances must hold d1 on entry.
+			 */
+			template<class Denominator, class Numerator, class D2>
+			static inline void classify(const Denominator& denominator,
+				const Numerator& numerator, const D2& d2,
+				Eigen::Ref<Distances> distances, Eigen::Ref<Types> types,
+				ValueType tolerance)
+			{
+				auto parallel   = denominator.abs() <= tolerance;
+				auto coincident = parallel && numerator.abs() <= tolerance;
+				auto hit        = denominator.abs() > tolerance &&
+					distances >= 0 && d2 >= 0 && d2 <= 1;
+
+				types = hit.template cast<int>() * int(INTERSECT) +
+					coincident.template cast<int>() * int(COINCIDENT);
+				distances = (types == INTERSECT).select(distances,
+					(types == COINCIDENT).select(
+						Distances::Zero(distances.size()),
+						std::numeric_limits<ValueType>::infinity()));
+			}
 	};
 
+	/**
+	 * Tests many rays against a block of segments. Column j of distances and
+	 * types receives the results of rays[j], as produced by
+	 * Ray::distance(const LineSegmentBlock&, ...).
+	 */
+	template<uint32_t DIM, typename ValueType>
+	void distance(const std::vector<Ray<DIM, ValueType>>& rays,
+		const LineSegmentBlock<DIM, ValueType>& segments,
+		Eigen::Ref<typename Ray<DIM, ValueType>::DistanceMatrix> distances,
+		Eigen::Ref<typename Ray<DIM, ValueType>::TypeMatrix> types,
+		ValueType tolerance = std::numeric_limits<ValueType>::epsilon() * 4)
+	{
+		for (size_t j = 0; j < rays.size(); ++j)
+			rays[j].distance(segments, distances.col(j), types.col(j),
+				tolerance);
+	}
+
 	typedef Ray<2> Ray2d;
 	typedef Ray<3> Ray3d;
 }
@@ -0,0 +1,177 @@
+//
+// Created on 10/17/2026.
+//
+
+#ifndef PROJECTS_RAYPACKET_HPP
+#define PROJECTS_RAYPACKET_HPP
+
+#include <stdint.h>
+#include <limits>
+#include "LineSegment.hpp"
+#include "Ray.hpp"
+
+namespace flabs
+{
+	/**
+	 * WIDTH rays traced together. Every component is stored as an array
+	 * over the lanes, so one box or segment test runs on all of them at once
+	 * in SIMD registers. Trees take packets of rays that start close together
+	 * and point the same way, such as the beams of one scan, and fall back to
+	 * tracing lanes one at a time where they part.
+	 *
+	 * Lanes past the rays the packet was made from repeat the first ray and
+	 * are left out of active.
+	 */
+	template<uint32_t DIM, typename ValueType = double, int WIDTH = 4>
+	class RayPacket
+	{
+		private:
+			typedef Ray<DIM, ValueType>         Ry;
+			typedef LineSegment<DIM, ValueType> Seg;
+			typedef Vector<DIM, ValueType>      Vec;
+
+		public:
+			static constexpr int SIZE = WIDTH;
+
+			typedef Eigen::Array<ValueType, WIDTH, 1>   Lanes;
+			typedef Eigen::Array<bool, WIDTH, 1>        Mask;
+			typedef Eigen::Array<uint32_t, WIDTH, 1>    Indices;
+			typedef Eigen::Array<ValueType, WIDTH, DIM> Components;
+
+		public:
+			Components start;
+			Components direction;
+			Components inverse;
+			Mask       active;
+
+		public:
+			RayPacket() : active(Mask::Constant(false))
+			{
+			}
+
+			/**
+			 * @param rays: the rays, count of them
+			 * @param count: at most WIDTH
+			 */
+			RayPacket(const Ry* rays, size_t count)
+			{
+				set(rays, count);
+			}
+
+			~RayPacket()
+			{
+			}
+
+			void set(const Ry* rays, size_t count)
+			{
+				for (int lane = 0; lane < WIDTH; ++lane)
+				{
+					const Ry& ray = rays[size_t(lane) < count ? lane : 0];
+					start.row(lane)     = ray.start.transpose().array();
+					direction.row(lane) =
+						ray.normalizedDirection.transpose().array();
+					active(lane) = size_t(lane) < count;
+				}
+				inverse = direction.inverse();
+			}
+
+			inline Ry ray(int lane) const
+			{
+				return Ry(start.row(lane).transpose().matrix(),
+					direction.row(lane).transpose().matrix());
+			}
+
+			/**
+			 * True if every active lane points into the same octant, so one
+			 * front to back child order suits all of them.
+			 */
+			bool coherent() const
+			{
+				for (uint32_t i = 0; i < DIM; ++i)
+				{
+					const auto negative = direction.col(i) < 0;
+					if ((active && negative).any() &&
+						(active && !negative).any())
+						return false;
+				}
+				return true;
+			}
+
+			/**
+			 * The first active lane, or -1 if there is none.
+			 */
+			static inline int first(const Mask& mask)
+			{
+				for (int lane = 0; lane < WIDTH; ++lane)
+					if (mask(lane))
+						return lane;
+				return -1;
+			}
+
+			/**
+			 * Slab test of every lane against the axis aligned box [lower,
+			 * upper]. [tmin, tmax] is narrowed to where each lane's line is
+			 * inside the box. Lanes in the plane of a face they run parallel
+			 * to produce NaN for that axis, which Eigen's min and max discard
+			 * the same way std::min/std::max do in the single ray tests.
+			 *
+			 * @return the lanes where the interval is not empty
+			 */
+			inline Mask slab(const Vec& lower, const Vec& upper, Lanes& tmin,
+				Lanes& tmax) const
+			{
+				for (uint32_t i = 0; i < DIM; ++i)
+				{
+					const Lanes t1 = (lower[i] - start.col(i)) * inverse.col(i);
+					const Lanes t2 = (upper[i] - start.col(i)) * inverse.col(i);
+					tmin = tmin.max(t1.min(t2));
+					tmax = tmax.min(t1.max(t2));
+				}
+				return tmin <= tmax;
+			}
+
+			/**
+			 * Packet form of Ray::distance(const LineSegment&, ValueType&),
+			 * for every lane against one segment. Only crossings count, lanes
+			 * collinear with the segment miss.
+			 *
+			 * @param distances: set to the distance along each lane's ray
+			 * @return the lanes that hit the segment
+			 */
+			inline Mask distance(const Seg& segment, Lanes& distances,
+				ValueType tolerance =
+				std::numeric_limits<ValueType>::epsilon() * 4) const
+			{
+				if constexpr (DIM == 2)
+				{
+					// n2 = orthogonal2d(extends) = (-e1, e0)
+					const Vec&  e           = segment.extends;
+					const Lanes w0          = segment.start(0) - start.col(0);
+					const Lanes w1          = segment.start(1) - start.col(1);
+					const Lanes denominator = direction.col(1) * e(0) -
+						direction.col(0) * e(1);
+					const Lanes d2          = (direction.col(0) * w1 -
+						direction.col(1) * w0) / denominator;
+
+					distances = (w1 * e(0) - w0 * e(1)) / denominator;
+					return denominator.abs() > tolerance && distances >= 0 &&
+						d2 >= 0 && d2 <= 1;
+				}
+				else
+				{
+					Mask hit;
+					for (int lane = 0; lane < WIDTH; ++lane)
+						hit(lane) = ray(lane).distance(segment,
+							distances(lane)) == INTERSECT;
+					return hit;
+				}
+			}
+	};
+
+	typedef RayPacket<2, double, 4> RayPacket2d;
+	typedef RayPacket<3, double, 4> RayPacket3d;
+	typedef RayPacket<2, float, 8>  RayPacket2f;
+	typedef RayPacket<3, float, 8>  RayPacket3f;
+}
+
+#endif //PROJECTS_RAYPACKET_HPP
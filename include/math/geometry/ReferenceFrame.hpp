@@ -5,23 +5,93 @@
 #ifndef PROJECTS_POSE_HPP
 #define PROJECTS_POSE_HPP
 
+#include <atomic>
 #include <Eigen/Eigen>
+#include "../Parallel.hpp"
+#include "../Trig.hpp"
 
 namespace flabs
 {
+	/**
+	 * Transform storage policy of a ReferenceFrame that keeps the full
+	 * (DIM+1)x(DIM+1) homogeneous matrix, so any affine offset can be stored.
+	 */
 	template<uint32_t DIM, class ValueType = double>
+	struct HomogeneousTransform
+	{
+		typedef Eigen::Matrix<ValueType, DIM + 1, DIM + 1> Type;
+
+		static inline Type compose(const Type& a, const Type& b)
+		{
+			return a * b;
+		}
+
+		static inline Type inverse(const Type& t)
+		{
+			return t.inverse();
+		}
+	};
+
+	/**
+	 * Transform storage policy of a ReferenceFrame for rigid motions. Only the
+	 * DIMxDIM rotation and the translation are stored, without the constant
+	 * bottom row, so composing costs a rotation product plus a rotated
+	 * translation, and inverting is a transpose.
+	 */
+	template<uint32_t DIM, class ValueType = double>
+	struct RigidTransform
+	{
+		typedef Eigen::Transform<ValueType, DIM, Eigen::AffineCompact> Type;
+
+		static inline Type compose(const Type& a, const Type& b)
+		{
+			return a * b;
+		}
+
+		static inline Type inverse(const Type& t)
+		{
+			return t.inverse(Eigen::Isometry);
+		}
+	};
+
+	/**
+	 * @tparam Storage: how the offset transform is stored, see
+	 *         HomogeneousTransform and RigidTransform
+	 * @tparam Trig: how yaw is converted to and from the rotation, ExactTrig
+	 *         or FastTrig
+	 */
+	template<uint32_t DIM, class ValueType = double,
+		class Storage = HomogeneousTransform<DIM, ValueType>,
+		class Trig = ExactTrig>
 	class ReferenceFrame
 	{
 		public:
-			typedef ReferenceFrame<DIM, ValueType>             Ref;
+			typedef ReferenceFrame<DIM, ValueType, Storage, Trig> Ref;
 			typedef Eigen::Matrix<ValueType, DIM, 1>           Vec;
 			typedef Eigen::Matrix<ValueType, DIM, DIM>         Rot;
-			typedef Eigen::Matrix<ValueType, DIM + 1, DIM + 1> Tran;
+			typedef typename Storage::Type                     Tran;
+			typedef Eigen::Matrix<ValueType, DIM, Eigen::Dynamic> Points;
 
 		public:
 			Ref* parent;
+
+			/**
+			 * The offset from the parent frame. Call invalidate() after
+			 * writing to it directly, the setters do so already.
+			 */
 			Tran transformationMatrix;
 
+		protected:
+			/**
+			 * Bumped whenever any frame changes. A cached offset from world is
+			 * valid while the generation it was computed in is current, so
+			 * repeated queries between changes are O(1).
+			 */
+			static inline std::atomic<uint64_t> generation{1};
+
+			mutable Tran     offsetFromWorld;
+			mutable uint64_t offsetFromWorldGeneration = 0;
+
 		public:
 			ReferenceFrame(Ref* parent = nullptr) : parent(parent)
 			{
@@ -29,29 +99,59 @@ namespace flabs
 			}
 
 			template<uint32_t U = DIM,
-				class = typename std::enable_if<DIM == 2>::type>
+				class = typename std::enable_if<U == 2>::type>
 			ReferenceFrame(ValueType x, ValueType y, ValueType yaw,
 				Ref* parent = nullptr) : parent(parent)
 			{
+				transformationMatrix.setIdentity();
 				setXOffset(x);
 				setYOffset(y);
 				setYawOffset(yaw);
-
-				transformationMatrix(2, 0) = 0;
-				transformationMatrix(2, 1) = 0;
-				transformationMatrix(2, 2) = 1;
 			}
 
 			virtual ~ReferenceFrame()
 			{
 			}
 
+			/**
+			 * Returns the offset from the world frame. The result is cached
+			 * and only recomputed, from the parent's cached offset, after some
+			 * frame has changed. Like any lazily cached value, concurrent
+			 * queries must be synchronised by the caller.
+			 */
 			Tran getOffsetFromWorld() const
 			{
-				if (parent)
-					return parent->getOffsetFromWorld() * transformationMatrix;
-				else
-					return transformationMatrix;
+				const uint64_t current = generation.load(
+					std::memory_order_relaxed);
+				if (offsetFromWorldGeneration != current)
+				{
+					if (parent)
+						offsetFromWorld = Storage::compose(
+							parent->getOffsetFromWorld(), transformationMatrix);
+					else
+						offsetFromWorld = transformationMatrix;
+					offsetFromWorldGeneration = current;
+				}
+				return offsetFromWorld;
+			}
+
+			/**
+			 * Returns the offset of the world frame from this frame, the
+			 * inverse of getOffsetFromWorld().
+			 */
+			Tran getOffsetToWorld() const
+			{
+				return Storage::inverse(getOffsetFromWorld());
+			}
+
+			/**
+			 * Marks every cached offset from world as stale. Needed after
+			 * writing transformationMatrix directly.
+			 */
+			inline Ref& invalidate()
+			{
+				generation.fetch_add(1, std::memory_order_relaxed);
+				return *this;
 			}
 
 			Ref* getParent() const
@@ -62,20 +162,19 @@ namespace flabs
 			void setParent(Ref* parent)
 			{
 				ReferenceFrame::parent = parent;
+				invalidate();
 			}
 
 			Vec getTranslationOffset()
 			{
-				return transformationMatrix.block<DIM, 1>(0, 2);
+				return transformationMatrix.matrix().template block<DIM, 1>(0,
+					DIM);
 			}
 
 			Vec getWorldPosition()
 			{
-				if (parent)
-					return (parent->getOffsetFromWorld() * transformationMatrix)
-						.block<DIM, 1>(0, 2);
-				else
-					return transformationMatrix.block<DIM, 1>(0, 2);
+				return getOffsetFromWorld().matrix().template block<DIM, 1>(0,
+					DIM);
 			}
 
 			inline ValueType getXOffset() const
@@ -86,7 +185,7 @@ namespace flabs
 			inline Ref& setXOffset(ValueType x)
 			{
 				transformationMatrix(0, DIM) = x;
-				return *this;
+				return invalidate();
 			};
 
 			template<uint32_t Dummy = DIM>
@@ -101,7 +200,7 @@ namespace flabs
 			setYOffset(ValueType y)
 			{
 				transformationMatrix(1, DIM) = y;
-				return *this;
+				return invalidate();
 			};
 
 			template<uint32_t Dummy = DIM>
@@ -116,14 +215,14 @@ namespace flabs
 			setZOffset(ValueType z)
 			{
 				transformationMatrix(2, DIM) = z;
-				return *this;
+				return invalidate();
 			};
 
 			template<uint32_t Dummy = DIM>
 			inline typename std::enable_if<Dummy == 2, ValueType>::type
 			getYawOffset() const
 			{
-				return std::atan2(this->transformationMatrix(1, 0),
+				return Trig::atan2(this->transformationMatrix(1, 0),
 					this->transformationMatrix(1, 1));
 			};
 
@@ -131,11 +230,13 @@ namespace flabs
 			inline typename std::enable_if<Dummy == 2, Ref&>::type
 			setYawOffset(ValueType yaw)
 			{
-				transformationMatrix(0, 0) = std::cos(yaw);
-				transformationMatrix(0, 1) = -std::sin(yaw);
-				transformationMatrix(1, 0) = std::sin(yaw);
-				transformationMatrix(1, 1) = std::cos(yaw);
-				return *this;
+				ValueType sin, cos;
+				Trig::sincos(yaw, sin, cos);
+				transformationMatrix(0, 0) = cos;
+				transformationMatrix(0, 1) = -sin;
+				transformationMatrix(1, 0) = sin;
+				transformationMatrix(1, 1) = cos;
+				return invalidate();
 			};
 
 			template<uint32_t Dummy = DIM>
@@ -145,7 +246,7 @@ namespace flabs
 				Tran offsetFromWorld = getOffsetFromWorld();
 				x   = offsetFromWorld(0, 2);
 				y   = offsetFromWorld(1, 2);
-				yaw = std::atan2(offsetFromWorld(1, 0), offsetFromWorld(1, 1));
+				yaw = Trig::atan2(offsetFromWorld(1, 0), offsetFromWorld(1, 1));
 				return *this;
 			};
 
@@ -156,7 +257,7 @@ namespace flabs
 				Tran offsetFromWorld = getOffsetFromWorld();
 				x   = offsetFromWorld(0, 2);
 				y   = offsetFromWorld(1, 2);
-				yaw = std::atan2(offsetFromWorld(1, 0), offsetFromWorld(1, 1));
+				yaw = Trig::atan2(offsetFromWorld(1, 0), offsetFromWorld(1, 1));
 				return *this;
 			};
 
@@ -181,8 +282,70 @@ namespace flabs
 			};
 	};
 
+	/**
+	 * Moves points given in frame from into frame to. The offset between the
+	 * frames is computed once, then applied to the whole block as one
+	 * rotation product plus a broadcast translation.
+	 *
+	 * @param from: the frame the points are given in
+	 * @param to: the frame to express the points in
+	 * @param in: one point per column, must not overlap out
+	 * @param out: receives the moved points, same size as in
+	 * @param threads: thread count, 0 for one per hardware thread. Each thread
+	 *        moves a contiguous range of columns.
+	 */
+	template<uint32_t DIM, class ValueType, class Storage, class Trig>
+	void transformPoints(
+		const ReferenceFrame<DIM, ValueType, Storage, Trig>& from,
+		const ReferenceFrame<DIM, ValueType, Storage, Trig>& to,
+		const Eigen::Ref<const typename
+		ReferenceFrame<DIM, ValueType, Storage, Trig>::Points>& in,
+		Eigen::Ref<typename ReferenceFrame<DIM, ValueType, Storage,
+			Trig>::Points> out, unsigned threads = 1)
+	{
+		const typename Storage::Type offset = Storage::compose(
+			to.getOffsetToWorld(), from.getOffsetFromWorld());
+		const Eigen::Matrix<ValueType, DIM, DIM> rotation =
+			offset.matrix().template topLeftCorner<DIM, DIM>();
+		const Eigen::Matrix<ValueType, DIM, 1>   translation =
+			offset.matrix().template block<DIM, 1>(0, DIM);
+
+		parallelFor(in.cols(), threadCount(threads, in.cols()),
+			[&](size_t begin, size_t end, unsigned)
+			{
+				auto block = out.middleCols(begin, end - begin);
+				block.noalias() = rotation * in.middleCols(begin, end - begin);
+				block.colwise() += translation;
+			});
+	}
+
+	/**
+	 * Moves count points given in frame from into frame to, see
+	 * transformPoints(from, to, in, out, threads).
+	 */
+	template<uint32_t DIM, class ValueType, class Storage, class Trig>
+	void transformPoints(
+		const ReferenceFrame<DIM, ValueType, Storage, Trig>& from,
+		const ReferenceFrame<DIM, ValueType, Storage, Trig>& to,
+		const typename ReferenceFrame<DIM, ValueType, Storage, Trig>::Vec* in,
+		typename ReferenceFrame<DIM, ValueType, Storage, Trig>::Vec* out,
+		size_t count,
+		unsigned threads = 1)
+	{
+		typedef typename ReferenceFrame<DIM, ValueType, Storage, Trig>::Points
+			Points;
+		transformPoints(from, to, Eigen::Map<const Points>(in->data(), DIM,
+			count), Eigen::Map<Points>(out->data(), DIM, count), threads);
+	}
+
 	typedef ReferenceFrame<2, double> ReferenceFrame2d;
 	typedef ReferenceFrame<3, double> ReferenceFrame3d;
+	typedef ReferenceFrame<2, double, RigidTransform<2, double>>
+		RigidReferenceFrame2d;
+	typedef ReferenceFrame<3, double, RigidTransform<3, double>>
+		RigidReferenceFrame3d;
+	typedef ReferenceFrame<2, double, RigidTransform<2, double>, FastTrig>
+		FastRigidReferenceFrame2d;
 }
 
 #endif //PROJECTS_POSE_HPP
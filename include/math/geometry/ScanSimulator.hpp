@@ -0,0 +1,201 @@
+//
+// Created on 10/17/2026.
+//
+
+#ifndef PROJECTS_SCANSIMULATOR_HPP
+#define PROJECTS_SCANSIMULATOR_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../Parallel.hpp"
+#include "LineSegment.hpp"
+#include "Ray.hpp"
+#include "RayPacket.hpp"
+#include "SegmentBVH.hpp"
+
+namespace flabs
+{
+	/**
+	 * Simulates a planar range sensor, such as a 2D lidar, in a map of wall
+	 * segments. A scan casts one ray per beam from the sensor pose and
+	 * reports the range to the nearest wall, or the maximum range where no
+	 * wall is hit.
+	 *
+	 * Beam directions are computed once, in the sensor frame, when the
+	 * pattern is set, so a scan only rotates them by the pose. Beams are cast
+	 * PACKET at a time through a SegmentBVH of the map, and the packets of
+	 * every requested scan are shared out among the threads of a WorkerPool
+	 * in chunks of grain. Results go straight into the caller's arrays, so
+	 * scanning does not allocate once the pose buffers have grown to the
+	 * largest batch.
+	 */
+	template<typename ValueType = double>
+	class ScanSimulator
+	{
+		public:
+			static constexpr int PACKET = 4;
+
+			typedef Vector<2, ValueType>                       Vec;
+			typedef LineSegment<2, ValueType>                  Seg;
+			typedef Ray<2, ValueType>                          Ry;
+			typedef RayPacket<2, ValueType, PACKET>            Packet;
+			typedef Eigen::Matrix<ValueType, 2, 2>             Rot;
+			typedef Eigen::Array<ValueType, Eigen::Dynamic, 1> Ranges;
+			typedef Eigen::Array<ValueType, Eigen::Dynamic, Eigen::Dynamic>
+				RangeMatrix;
+
+		protected:
+			SegmentBVH<2, ValueType>                   map;
+			Eigen::Array<ValueType, Eigen::Dynamic, 2> directions;
+			ValueType                                  maxRange = 0;
+			WorkerPool                                 pool;
+			size_t                                     grain;
+			std::vector<Vec>                           origins;
+			std::vector<Rot>                           rotations;
+
+		public:
+			/**
+			 * @param threads: thread count including the caller, 0 for one
+			 *        per hardware thread
+			 * @param grain: how many packets a thread takes at a time
+			 */
+			explicit ScanSimulator(unsigned threads = 0, size_t grain = 16) :
+				pool(threads), grain(grain)
+			{
+			}
+
+			virtual ~ScanSimulator()
+			{
+			}
+
+			inline void setMap(const std::vector<Seg>& segments)
+			{
+				map.build(segments);
+			}
+
+			inline const SegmentBVH<2, ValueType>& getMap() const
+			{
+				return map;
+			}
+
+			/**
+			 * Sets the beam pattern.
+			 *
+			 * @param angles: the direction of each beam, in radians from the
+			 *        x axis of the sensor frame
+			 * @param maxRange: the range reported for beams that hit nothing
+			 *        closer
+			 */
+			void setBeams(const Ranges& angles, ValueType maxRange)
+			{
+				directions.resize(angles.size(), 2);
+				directions.col(0) = angles.cos();
+				directions.col(1) = angles.sin();
+				this->maxRange = maxRange;
+			}
+
+			/**
+			 * Sets count beams spread evenly from first to last, inclusive.
+			 */
+			inline void setBeams(size_t count, ValueType first, ValueType last,
+				ValueType maxRange)
+			{
+				setBeams(count > 1 ? Ranges(Ranges::LinSpaced(count, first,
+					last)) : Ranges(Ranges::Constant(count, first)), maxRange);
+			}
+
+			inline size_t beams() const
+			{
+				return directions.rows();
+			}
+
+			inline ValueType getMaxRange() const
+			{
+				return maxRange;
+			}
+
+			inline unsigned threads() const
+			{
+				return pool.size();
+			}
+
+			/**
+			 * Simulates one scan.
+			 *
+			 * @param pose: the sensor frame, any 2D ReferenceFrame
+			 * @param ranges: receives one range per beam, must hold beams()
+			 * @return false if ranges has the wrong size
+			 */
+			template<class Frame>
+			bool scan(const Frame& pose, Eigen::Ref<Ranges> ranges)
+			{
+				const Frame* poses = &pose;
+				return scan(&poses, 1, Eigen::Map<RangeMatrix>(ranges.data(),
+					ranges.rows(), 1));
+			}
+
+			/**
+			 * Simulates one scan per pose, all of them in one parallel pass.
+			 *
+			 * @param poses: the sensor frames, count of them. Their offsets
+			 *        from world are read on the calling thread.
+			 * @param ranges: column j receives the ranges of poses[j], must
+			 *        be beams() by count
+			 * @return false if ranges has the wrong size
+			 */
+			template<class Frame>
+			bool scan(const Frame* const* poses, size_t count,
+				Eigen::Ref<RangeMatrix> ranges)
+			{
+				if (size_t(ranges.rows()) != beams() ||
+					size_t(ranges.cols()) != count)
+					return false;
+
+				origins.resize(count);
+				rotations.resize(count);
+				for (size_t j = 0; j < count; ++j)
+				{
+					const auto offset = poses[j]->getOffsetFromWorld();
+					rotations[j] = offset.matrix().template topLeftCorner<2,
+						2>();
+					origins[j]   = offset.matrix().template block<2, 1>(0, 2);
+				}
+
+				const size_t packets = (beams() + PACKET - 1) / PACKET;
+				pool.run(packets * count, grain,
+					[&](size_t begin, size_t end, unsigned)
+					{
+						for (size_t item = begin; item < end; ++item)
+							cast(item / packets, item % packets * PACKET,
+								ranges);
+					});
+				return true;
+			}
+
+		protected:
+			/**
+			 * Casts the packet of beams from first for pose j.
+			 */
+			void cast(size_t j, size_t first, Eigen::Ref<RangeMatrix>& ranges)
+				const
+			{
+				const size_t count = std::min<size_t>(PACKET, beams() - first);
+				Ry           rays[PACKET];
+				for (size_t lane = 0; lane < count; ++lane)
+					rays[lane] = Ry(origins[j], rotations[j] *
+						directions.row(first + lane).transpose().matrix());
+
+				const Packet             packet(rays, count);
+				typename Packet::Indices ids;
+				typename Packet::Lanes   distances;
+				map.raycast(packet, ids, distances, maxRange);
+				ranges.col(j).segment(first, count) = distances.head(count);
+			}
+	};
+
+	typedef ScanSimulator<double> ScanSimulator2d;
+}
+
+#endif //PROJECTS_SCANSIMULATOR_HPP
@@ -0,0 +1,585 @@
+//
+// Created on 10/17/2026.
+//
+
+#ifndef PROJECTS_SEGMENTBVH_HPP
+#define PROJECTS_SEGMENTBVH_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "../Parallel.hpp"
+#include "LineSegment.hpp"
+#include "Ray.hpp"
+#include "RayPacket.hpp"
+
+namespace flabs
+{
+	/**
+	 * A bounding volume hierarchy over line segments, for casting rays
+	 * against walls without testing each of them.
+	 *
+	 * The tree is built top down with a binned surface area heuristic: the
+	 * segment centroids are dropped into BINS buckets along the widest axis
+	 * and the split minimising the summed area times count of both sides is
+	 * kept, unless a leaf is cheaper. In 2D the perimeter stands in for the
+	 * area. Nodes are stored depth first, so the left child of a node is the
+	 * next node and only the right child is addressed by index, and each leaf
+	 * covers a contiguous range of the segments, which are reordered to
+	 * match.
+	 *
+	 * Segments keep the index they were given to build(). update() moves one
+	 * of them and refits the boxes above it, while many moves are cheaper
+	 * with set() followed by a single refit(). Both keep the topology, so the
+	 * tree degrades as segments drift far from where they were built, and
+	 * should then be rebuilt.
+	 */
+	template<uint32_t DIM, typename ValueType = double>
+	class SegmentBVH
+	{
+		static_assert(DIM >= 2, "SegmentBVH needs at least 2 dimensions");
+
+		protected:
+			typedef Vector<DIM, ValueType>      Vec;
+			typedef LineSegment<DIM, ValueType> Seg;
+			typedef Ray<DIM, ValueType>         Ry;
+
+			static constexpr uint32_t BINS       = 16;
+			static constexpr uint32_t MAX_DEPTH  = 64;
+			static constexpr uint32_t NULL_INDEX = 0xFFFFFFFF;
+
+			/**
+			 * A box. Inner nodes have count 0, their left child follows them
+			 * and offset is the right child. Leaves hold count segments from
+			 * offset.
+			 */
+			struct Node
+			{
+				Vec      lower;
+				Vec      upper;
+				uint32_t offset;
+				uint32_t count;
+				uint32_t axis;
+				uint32_t parent;
+			};
+
+			struct Bin
+			{
+				Vec      lower;
+				Vec      upper;
+				uint32_t count;
+			};
+
+			std::vector<Node>     nodes;
+			std::vector<Seg>      segments;
+			std::vector<Vec>      centroids;
+			std::vector<uint32_t> ids;
+			std::vector<uint32_t> positions;
+			std::vector<uint32_t> leaves;
+			uint32_t              leafSize;
+
+		public:
+			/**
+			 * @param leafSize: the most segments a leaf holds before the
+			 *        heuristic is asked whether to split it
+			 */
+			explicit SegmentBVH(uint32_t leafSize = 4) :
+				leafSize(std::max(1u, leafSize))
+			{
+			}
+
+			SegmentBVH(const std::vector<Seg>& segments,
+				uint32_t leafSize = 4) : leafSize(std::max(1u, leafSize))
+			{
+				build(segments);
+			}
+
+			virtual ~SegmentBVH()
+			{
+			}
+
+			/**
+			 * Replaces the contents of the tree with segments. Segment i of
+			 * the input keeps id i.
+			 */
+			void build(const std::vector<Seg>& segments)
+			{
+				const uint32_t count = segments.size();
+				this->segments = segments;
+				nodes.clear();
+				centroids.resize(count);
+				ids.resize(count);
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					centroids[i] = segments[i].start + segments[i].extends / 2;
+					ids[i]       = i;
+				}
+
+				if (count)
+				{
+					nodes.reserve(2 * (count / leafSize) + 1);
+					split(0, count, NULL_INDEX, 0);
+				}
+
+				// Put the segments in leaf order
+				positions.resize(count);
+				leaves.resize(count);
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					this->segments[i] = segments[ids[i]];
+					positions[ids[i]] = i;
+				}
+				for (uint32_t node = 0; node < nodes.size(); ++node)
+					for (uint32_t i = 0; i < nodes[node].count; ++i)
+						leaves[nodes[node].offset + i] = node;
+				centroids.clear();
+			}
+
+			/**
+			 * Moves segment id and grows or shrinks the boxes above it,
+			 * stopping at the first one that does not change.
+			 */
+			void update(uint32_t id, const Seg& segment)
+			{
+				const uint32_t position = positions[id];
+				segments[position] = segment;
+				for (uint32_t node = leaves[position]; node != NULL_INDEX;
+					node = nodes[node].parent)
+				{
+					const Vec lower = nodes[node].lower;
+					const Vec upper = nodes[node].upper;
+					fit(node);
+					if (lower == nodes[node].lower &&
+						upper == nodes[node].upper)
+						break;
+				}
+			}
+
+			/**
+			 * Moves segment id without touching the boxes. Call refit() before
+			 * the next query.
+			 */
+			inline void set(uint32_t id, const Seg& segment)
+			{
+				segments[positions[id]] = segment;
+			}
+
+			/**
+			 * Recomputes every box, bottom up, after set().
+			 */
+			void refit()
+			{
+				for (uint32_t node = nodes.size(); node-- > 0;)
+					fit(node);
+			}
+
+			inline const Seg& segment(uint32_t id) const
+			{
+				return segments[positions[id]];
+			}
+
+			inline size_t size() const
+			{
+				return segments.size();
+			}
+
+			inline bool empty() const
+			{
+				return segments.empty();
+			}
+
+			/**
+			 * Finds the nearest segment the ray hits, as reported by
+			 * Ray::distance(). Children are visited near side first along the
+			 * axis they were split on, and boxes starting beyond the nearest
+			 * hit so far are skipped. Segments collinear with the ray are not
+			 * hits.
+			 *
+			 * @param ray: the ray to cast
+			 * @param id: set to the id of the segment hit
+			 * @param distance: set to the distance along the ray to the hit
+			 * @param maxDistance: hits farther than this are ignored
+			 * @return true if a segment was hit
+			 */
+			bool raycast(const Ry& ray, uint32_t& id, ValueType& distance,
+				ValueType maxDistance =
+				std::numeric_limits<ValueType>::infinity()) const
+			{
+				if (nodes.empty())
+					return false;
+
+				uint32_t best = NULL_INDEX;
+				distance = maxDistance;
+				traverse(0, ray, best, distance);
+				if (best == NULL_INDEX)
+					return false;
+				id = ids[best];
+				return true;
+			}
+
+			/**
+			 * Packet form of raycast(const Ry&, ...). All active lanes descend
+			 * together, each node being slab tested for every lane at once,
+			 * and a subtree is skipped once no lane reaches it before its
+			 * nearest hit. Where only one lane is left, or when the lanes do
+			 * not point into the same octant, lanes are traced one at a time.
+			 *
+			 * @param packet: the rays to cast
+			 * @param hitIds: set to the id of the segment each lane hit, or
+			 *        0xFFFFFFFF
+			 * @param distances: set to each lane's distance to its hit, or
+			 *        maxDistance
+			 */
+			template<int WIDTH>
+			void raycast(const RayPacket<DIM, ValueType, WIDTH>& packet,
+				typename RayPacket<DIM, ValueType, WIDTH>::Indices& hitIds,
+				typename RayPacket<DIM, ValueType, WIDTH>::Lanes& distances,
+				ValueType maxDistance =
+				std::numeric_limits<ValueType>::infinity()) const
+			{
+				typedef RayPacket<DIM, ValueType, WIDTH> Packet;
+				typedef typename Packet::Lanes           Lanes;
+				typedef typename Packet::Mask            Mask;
+
+				hitIds.setConstant(NULL_INDEX);
+				distances.setConstant(maxDistance);
+				if (nodes.empty())
+					return;
+
+				if (!packet.coherent())
+				{
+					for (int lane = 0; lane < WIDTH; ++lane)
+						if (packet.active(lane))
+							traverse(0, packet.ray(lane), hitIds(lane),
+								distances(lane));
+				}
+				else
+				{
+					const int lead  = Packet::first(packet.active);
+					uint32_t  stack[MAX_DEPTH];
+					uint32_t  top   = 0;
+					uint32_t  index = 0;
+					while (lead >= 0)
+					{
+						const Node& node = nodes[index];
+						Lanes       tmin = Lanes::Zero();
+						Lanes       tmax = distances;
+						const Mask  hit  = packet.active &&
+							packet.slab(node.lower, node.upper, tmin, tmax);
+						const int   lanes = hit.count();
+						if (lanes == 1)
+						{
+							const int lane = Packet::first(hit);
+							traverse(index, packet.ray(lane), hitIds(lane),
+								distances(lane));
+						}
+						else if (lanes && node.count)
+						{
+							for (uint32_t i = node.offset;
+								i < node.offset + node.count; ++i)
+							{
+								Lanes      hits;
+								const Mask closer = hit &&
+									packet.distance(segments[i], hits) &&
+									hits <= distances;
+								hitIds    = closer.select(i, hitIds);
+								distances = closer.select(hits, distances);
+							}
+						}
+						else if (lanes)
+						{
+							const bool far =
+								packet.direction(lead, node.axis) < 0;
+							stack[top++] = far ? index + 1 : node.offset;
+							index = far ? node.offset : index + 1;
+							continue;
+						}
+						if (top == 0)
+							break;
+						index = stack[--top];
+					}
+				}
+
+				for (int lane = 0; lane < WIDTH; ++lane)
+					if (hitIds(lane) != NULL_INDEX)
+						hitIds(lane) = ids[hitIds(lane)];
+			}
+
+			/**
+			 * Casts every ray, split across threads. Rays that miss get an id
+			 * of 0xFFFFFFFF and an infinite distance.
+			 *
+			 * @param threads: thread count, 0 for one per hardware thread
+			 */
+			void raycast(const std::vector<Ry>& rays,
+				std::vector<uint32_t>& hitIds,
+				std::vector<ValueType>& distances, unsigned threads = 0) const
+			{
+				hitIds.resize(rays.size());
+				distances.resize(rays.size());
+				parallelFor(rays.size(), threadCount(threads, rays.size()),
+					[&](size_t begin, size_t end, unsigned)
+					{
+						for (size_t i = begin; i < end; ++i)
+							if (!raycast(rays[i], hitIds[i], distances[i]))
+							{
+								hitIds[i]    = NULL_INDEX;
+								distances[i] =
+									std::numeric_limits<ValueType>::infinity();
+							}
+					});
+			}
+
+		protected:
+			/**
+			 * Casts ray through the subtree below root, lowering distance to
+			 * any nearer hit and setting best to the position of its segment.
+			 */
+			void traverse(uint32_t root, const Ry& ray, uint32_t& best,
+				ValueType& distance) const
+			{
+				const Vec inverse = ray.normalizedDirection.cwiseInverse();
+				uint32_t  stack[MAX_DEPTH];
+				uint32_t  top   = 0;
+				uint32_t  index = root;
+				while (true)
+				{
+					const Node& node = nodes[index];
+					if (slab(node, ray.start, inverse, distance))
+					{
+						if (node.count)
+						{
+							for (uint32_t i = node.offset;
+								i < node.offset + node.count; ++i)
+							{
+								ValueType hit;
+								if (ray.distance(segments[i], hit) ==
+									INTERSECT && hit <= distance)
+								{
+									best     = i;
+									distance = hit;
+								}
+							}
+						}
+						else
+						{
+							const bool far =
+								ray.normalizedDirection[node.axis] < 0;
+							stack[top++] = far ? index + 1 : node.offset;
+							index = far ? node.offset : index + 1;
+							continue;
+						}
+					}
+					if (top == 0)
+						break;
+					index = stack[--top];
+				}
+			}
+
+			/**
+			 * Slab test of a ray against a node's box, limited to
+			 * [0, maxDistance]. Flat boxes around axis aligned walls produce
+			 * NaN for a ray in their plane, which std::min/std::max discard.
+			 */
+			static inline bool slab(const Node& node, const Vec& start,
+				const Vec& inverse, ValueType maxDistance)
+			{
+				ValueType tmin = 0;
+				ValueType tmax = maxDistance;
+				for (uint32_t i = 0; i < DIM; ++i)
+				{
+					const ValueType t1 = (node.lower[i] - start[i]) * inverse[i];
+					const ValueType t2 = (node.upper[i] - start[i]) * inverse[i];
+					tmin = std::max(tmin, std::min(t1, t2));
+					tmax = std::min(tmax, std::max(t1, t2));
+				}
+				return tmin <= tmax;
+			}
+
+			/**
+			 * Half the surface area of a box, or its half perimeter in 2D.
+			 */
+			static inline ValueType area(const Vec& lower, const Vec& upper)
+			{
+				const Vec extent = (upper - lower).cwiseMax(Vec::Zero());
+				if constexpr (DIM == 2)
+					return extent[0] + extent[1];
+				else
+				{
+					ValueType total = 0;
+					for (uint32_t i = 0; i < DIM; ++i)
+						for (uint32_t j = i + 1; j < DIM; ++j)
+							total += extent[i] * extent[j];
+					return total;
+				}
+			}
+
+			static inline void grow(Vec& lower, Vec& upper, const Seg& segment)
+			{
+				const Vec end = segment.start + segment.extends;
+				lower = lower.cwiseMin(segment.start).cwiseMin(end);
+				upper = upper.cwiseMax(segment.start).cwiseMax(end);
+			}
+
+			void fit(uint32_t index)
+			{
+				Node& node = nodes[index];
+				if (node.count)
+				{
+					node.lower = Vec::Constant(
+						std::numeric_limits<ValueType>::infinity());
+					node.upper = -node.lower;
+					for (uint32_t i = node.offset; i < node.offset + node.count;
+						++i)
+						grow(node.lower, node.upper, segments[i]);
+				}
+				else
+				{
+					const Node& left  = nodes[index + 1];
+					const Node& right = nodes[node.offset];
+					node.lower = left.lower.cwiseMin(right.lower);
+					node.upper = left.upper.cwiseMax(right.upper);
+				}
+			}
+
+			/**
+			 * Emits the subtree of ids [begin, end) and returns its index.
+			 * segments is still in input order here.
+			 */
+			uint32_t split(uint32_t begin, uint32_t end, uint32_t parent,
+				uint32_t depth)
+			{
+				const uint32_t index = nodes.size();
+				nodes.push_back({});
+				Node& node = nodes.back();
+				node.offset = begin;
+				node.count  = end - begin;
+				node.axis   = 0;
+				node.parent = parent;
+				node.lower  = Vec::Constant(
+					std::numeric_limits<ValueType>::infinity());
+				node.upper  = -node.lower;
+
+				Vec lower = node.lower;
+				Vec upper = node.upper;
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					grow(node.lower, node.upper, segments[ids[i]]);
+					lower = lower.cwiseMin(centroids[ids[i]]);
+					upper = upper.cwiseMax(centroids[ids[i]]);
+				}
+
+				if (end - begin <= leafSize || depth + 1 >= MAX_DEPTH)
+					return index;
+
+				uint32_t axis;
+				const ValueType extent = (upper - lower).maxCoeff(&axis);
+				uint32_t middle;
+				if (extent > 0)
+				{
+					middle = partition(begin, end, axis, lower[axis], extent,
+						area(node.lower, node.upper) * (end - begin));
+					if (middle == NULL_INDEX)
+						return index;
+				}
+				else
+					middle = begin + (end - begin) / 2;
+
+				nodes[index].count = 0;
+				nodes[index].axis  = axis;
+				split(begin, middle, index, depth + 1);
+				const uint32_t right = split(middle, end, index, depth + 1);
+				nodes[index].offset = right;
+				return index;
+			}
+
+			/**
+			 * Bins [begin, end) by centroid along axis, partitions it at the
+			 * cheapest bin boundary and returns the first id on the right, or
+			 * NULL_INDEX if a leaf costing leafCost is cheaper and allowed.
+			 */
+			uint32_t partition(uint32_t begin, uint32_t end, uint32_t axis,
+				ValueType lower, ValueType extent, ValueType leafCost)
+			{
+				const ValueType scale = BINS * (1 - ValueType(1e-6)) / extent;
+				auto            binOf = [&](uint32_t id)
+				{
+					return std::min(BINS - 1, (uint32_t) ((centroids[id][axis] -
+						lower) * scale));
+				};
+
+				Bin bins[BINS];
+				for (Bin& bin : bins)
+				{
+					bin.lower = Vec::Constant(
+						std::numeric_limits<ValueType>::infinity());
+					bin.upper = -bin.lower;
+					bin.count = 0;
+				}
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					Bin& bin = bins[binOf(ids[i])];
+					grow(bin.lower, bin.upper, segments[ids[i]]);
+					++bin.count;
+				}
+
+				// Cost of the right side of every boundary, then sweep from
+				// the left for the cheapest one
+				ValueType rightCost[BINS];
+				Vec       boxLower = bins[BINS - 1].lower;
+				Vec       boxUpper = bins[BINS - 1].upper;
+				uint32_t  count    = bins[BINS - 1].count;
+				for (uint32_t b = BINS - 1; b > 0; --b)
+				{
+					rightCost[b] = area(boxLower, boxUpper) * count;
+					boxLower = boxLower.cwiseMin(bins[b - 1].lower);
+					boxUpper = boxUpper.cwiseMax(bins[b - 1].upper);
+					count += bins[b - 1].count;
+				}
+
+				ValueType bestCost = std::numeric_limits<ValueType>::infinity();
+				uint32_t  bestBin  = 0;
+				boxLower = bins[0].lower;
+				boxUpper = bins[0].upper;
+				count    = bins[0].count;
+				for (uint32_t b = 1; b < BINS; ++b)
+				{
+					const ValueType cost = area(boxLower, boxUpper) * count +
+						rightCost[b];
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestBin  = b;
+					}
+					boxLower = boxLower.cwiseMin(bins[b].lower);
+					boxUpper = boxUpper.cwiseMax(bins[b].upper);
+					count += bins[b].count;
+				}
+
+				if (bestCost >= leafCost && end - begin <= 4 * leafSize)
+					return NULL_INDEX;
+
+				uint32_t* middle = std::partition(ids.data() + begin,
+					ids.data() + end, [&](uint32_t id)
+					{
+						return binOf(id) < bestBin;
+					});
+				if (middle == ids.data() + begin || middle == ids.data() + end)
+				{
+					middle = ids.data() + begin + (end - begin) / 2;
+					std::nth_element(ids.data() + begin, middle,
+						ids.data() + end, [&](uint32_t a, uint32_t b)
+						{
+							return centroids[a][axis] < centroids[b][axis];
+						});
+				}
+				return middle - ids.data();
+			}
+	};
+
+	typedef SegmentBVH<2> SegmentBVH2d;
+	typedef SegmentBVH<3> SegmentBVH3d;
+}
+
+#endif //PROJECTS_SEGMENTBVH_HPP
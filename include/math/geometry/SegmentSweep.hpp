@@ -0,0 +1,379 @@
+//
+// Created on 10/17/2026.
+//
+
+#ifndef PROJECTS_SEGMENTSWEEP_HPP
+#define PROJECTS_SEGMENTSWEEP_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <vector>
+#include "GeometryCalculator.hpp"
+#include "LineSegment.hpp"
+
+namespace flabs
+{
+	/**
+	 * Classifies two segments: INTERSECT if they cross or touch in a single
+	 * point, COINCIDENT if they are collinear and overlap, NONE otherwise.
+	 * Segments must have a non-zero length, degenerate ones never intersect.
+	 *
+	 * @param point: receives the intersection when INTERSECT
+	 * @param tolerance: relative tolerance, segments touch if they miss by
+	 *        less than tolerance times their lengths
+	 */
+	template<typename ValueType>
+	IntersectionType segmentIntersection(const LineSegment<2, ValueType>& a,
+		const LineSegment<2, ValueType>& b, Vector<2, ValueType>& point,
+		ValueType tolerance = ValueType(1e-9))
+	{
+		const ValueType lengthA = a.extends.squaredNorm();
+		const ValueType lengthB = b.extends.squaredNorm();
+		if (lengthA == 0 || lengthB == 0)
+			return NONE;
+
+		ValueType        d1, d2;
+		IntersectionType type = intersectionDistance(a.start, a.extends,
+			b.start, b.extends, point, d1, d2,
+			tolerance * std::sqrt(lengthA * lengthB));
+		if (type == COINCIDENT)
+		{
+			// b's span projected onto a, in units of a
+			const ValueType t0 = (b.start - a.start).dot(a.extends) / lengthA;
+			const ValueType t1 = t0 + b.extends.dot(a.extends) / lengthA;
+			return std::max(std::min(t0, t1), ValueType(0)) <=
+				std::min(std::max(t0, t1), ValueType(1)) + tolerance ?
+				COINCIDENT : NONE;
+		}
+
+		return type == INTERSECT && d1 >= -tolerance && d1 <= 1 + tolerance &&
+			d2 >= -tolerance && d2 <= 1 + tolerance ? INTERSECT : NONE;
+	}
+
+	template<typename ValueType>
+	inline IntersectionType segmentIntersection(
+		const LineSegment<2, ValueType>& a, const LineSegment<2, ValueType>& b,
+		ValueType tolerance = ValueType(1e-9))
+	{
+		Vector<2, ValueType> point;
+		return segmentIntersection(a, b, point, tolerance);
+	}
+
+	/**
+	 * Two intersecting segments, by index, first < second.
+	 */
+	struct SegmentPair
+	{
+		uint32_t         first;
+		uint32_t         second;
+		IntersectionType type;
+
+		inline bool operator<(const SegmentPair& pair) const
+		{
+			return first < pair.first ||
+				(first == pair.first && second < pair.second);
+		}
+
+		inline bool operator==(const SegmentPair& pair) const
+		{
+			return first == pair.first && second == pair.second &&
+				type == pair.type;
+		}
+	};
+
+	/**
+	 * Finds every intersecting pair of a set of 2D segments with the
+	 * Bentley-Ottmann sweep, in O((n + k) log n) for n segments and k
+	 * intersections. A vertical line sweeps left to right, stopping at
+	 * endpoints and at crossings found between segments that become
+	 * neighbours. At each stop every segment through the stop point is
+	 * gathered, so several segments meeting at one point, shared
+	 * endpoints, and overlapping collinear segments are all reported. Pairs
+	 * are classified with segmentIntersection().
+	 *
+	 * The buffers are kept between calls to find().
+	 */
+	template<typename ValueType = double>
+	class SegmentSweep
+	{
+		public:
+			typedef LineSegment<2, ValueType> Seg;
+			typedef Vector<2, ValueType>      Vec;
+
+		protected:
+			struct PointLess
+			{
+				inline bool operator()(const Vec& a, const Vec& b) const
+				{
+					return a(0) < b(0) || (a(0) == b(0) && a(1) < b(1));
+				}
+			};
+
+			/**
+			 * A height on the sweep line, to search the status by.
+			 */
+			struct Probe
+			{
+				ValueType y;
+			};
+
+			/**
+			 * Orders segments bottom to top where they cross the sweep line,
+			 * just after the current stop.
+			 */
+			struct StatusLess
+			{
+				typedef void is_transparent;
+
+				const SegmentSweep* sweep;
+
+				inline bool operator()(uint32_t a, uint32_t b) const
+				{
+					return sweep->below(a, b);
+				}
+
+				inline bool operator()(uint32_t a, const Probe& probe) const
+				{
+					return sweep->height(a) < probe.y;
+				}
+
+				inline bool operator()(const Probe& probe, uint32_t a) const
+				{
+					return probe.y < sweep->height(a);
+				}
+			};
+
+			typedef std::set<uint32_t, StatusLess> Status;
+
+			const std::vector<Seg>* segments = nullptr;
+			std::vector<Vec>        lefts;
+			std::vector<Vec>        rights;
+			std::vector<ValueType>  slopes;
+
+			/**
+			 * Stops still to visit, with the segments starting at each
+			 */
+			std::map<Vec, std::vector<uint32_t>, PointLess> events;
+			Status                                          status;
+			std::vector<uint32_t>                           found;
+			std::unordered_set<uint64_t>                    reported;
+
+			Vec       sweep;
+			ValueType tolerance;
+			ValueType distanceTolerance;
+
+		public:
+			SegmentSweep() : status(StatusLess{this})
+			{
+			}
+
+			SegmentSweep(const SegmentSweep&) = delete;
+			SegmentSweep& operator=(const SegmentSweep&) = delete;
+
+			virtual ~SegmentSweep()
+			{
+			}
+
+			/**
+			 * Finds every intersecting pair of segments.
+			 *
+			 * @param segments: the segments, with non-zero lengths
+			 * @param pairs: receives the pairs, sorted
+			 * @param tolerance: relative tolerance, see segmentIntersection()
+			 * @return the number of pairs
+			 */
+			size_t find(const std::vector<Seg>& segments,
+				std::vector<SegmentPair>& pairs,
+				ValueType tolerance = ValueType(1e-9))
+			{
+				this->segments  = &segments;
+				this->tolerance = tolerance;
+				pairs.clear();
+				reported.clear();
+				status.clear();
+				events.clear();
+
+				ValueType scale = 1;
+				lefts.resize(segments.size());
+				rights.resize(segments.size());
+				slopes.resize(segments.size());
+				for (uint32_t i = 0; i < segments.size(); ++i)
+				{
+					Vec a = segments[i].start;
+					Vec b = segments[i].start + segments[i].extends;
+					if (PointLess()(b, a))
+						std::swap(a, b);
+					lefts[i]  = a;
+					rights[i] = b;
+					slopes[i] = a(0) == b(0) ?
+								std::numeric_limits<ValueType>::infinity() :
+								(b(1) - a(1)) / (b(0) - a(0));
+					scale = std::max(scale, std::max(a.cwiseAbs().maxCoeff(),
+						b.cwiseAbs().maxCoeff()));
+
+					if (segments[i].extends.squaredNorm() != 0)
+					{
+						events[a].push_back(i);
+						events[b];
+					}
+				}
+				distanceTolerance = tolerance * scale;
+
+				while (!events.empty())
+				{
+					auto event = events.begin();
+					visit(event->first, event->second, pairs);
+					events.erase(event);
+				}
+
+				std::sort(pairs.begin(), pairs.end());
+				this->segments = nullptr;
+				return pairs.size();
+			}
+
+		protected:
+			/**
+			 * The height of segment s on the sweep line. A vertical segment
+			 * sits at the stop's height, clamped to its span, as if the sweep
+			 * line were tilted infinitesimally.
+			 */
+			inline ValueType height(uint32_t s) const
+			{
+				if (slopes[s] == std::numeric_limits<ValueType>::infinity())
+					return std::min(std::max(sweep(1), lefts[s](1)),
+						rights[s](1));
+				return lefts[s](1) + (sweep(0) - lefts[s](0)) * slopes[s];
+			}
+
+			inline bool below(uint32_t a, uint32_t b) const
+			{
+				if (a == b)
+					return false;
+				const ValueType ya = height(a);
+				const ValueType yb = height(b);
+				if (ya < yb - distanceTolerance)
+					return true;
+				if (yb < ya - distanceTolerance)
+					return false;
+				if (slopes[a] != slopes[b])
+					return slopes[a] < slopes[b];
+				return a < b;
+			}
+
+			void report(uint32_t a, uint32_t b, IntersectionType type,
+				std::vector<SegmentPair>& pairs)
+			{
+				if (a > b)
+					std::swap(a, b);
+				if (reported.insert(uint64_t(a) << 32 | b).second)
+					pairs.push_back({a, b, type});
+			}
+
+			/**
+			 * Tests two segments that have become neighbours. A crossing to
+			 * the right of the sweep line becomes a stop.
+			 */
+			void check(uint32_t a, uint32_t b, std::vector<SegmentPair>& pairs)
+			{
+				Vec              point;
+				IntersectionType type = segmentIntersection((*segments)[a],
+					(*segments)[b], point, tolerance);
+				if (type == COINCIDENT)
+					report(a, b, type, pairs);
+				else if (type == INTERSECT && PointLess()(sweep, point) &&
+					(point - sweep).cwiseAbs().maxCoeff() > distanceTolerance)
+					events[point];
+			}
+
+			void visit(const Vec& point, const std::vector<uint32_t>& starting,
+				std::vector<SegmentPair>& pairs)
+			{
+				sweep = point;
+
+				// Segments on the sweep line through the stop, ending here or
+				// passing through
+				auto begin = status.lower_bound(
+					Probe{point(1) - distanceTolerance});
+				auto end   = begin;
+				found.clear();
+				while (end != status.end() &&
+					height(*end) <= point(1) + distanceTolerance)
+					found.push_back(*end++);
+
+				found.insert(found.end(), starting.begin(), starting.end());
+				for (size_t i = 0; i < found.size(); ++i)
+					for (size_t j = i + 1; j < found.size(); ++j)
+					{
+						IntersectionType type = segmentIntersection(
+							(*segments)[found[i]], (*segments)[found[j]],
+							tolerance);
+						if (type != NONE)
+							report(found[i], found[j], type, pairs);
+					}
+
+				// Reinsert what continues past the stop, which reorders it by
+				// slope, then test the new neighbours
+				status.erase(begin, end);
+				for (uint32_t s : found)
+					if ((rights[s] - point).cwiseAbs().maxCoeff() >
+						distanceTolerance)
+						status.insert(s);
+
+				auto lower = status.lower_bound(
+					Probe{point(1) - distanceTolerance});
+				auto upper = lower;
+				while (upper != status.end() &&
+					height(*upper) <= point(1) + distanceTolerance)
+					++upper;
+
+				if (lower != status.begin() && lower != status.end())
+					check(*std::prev(lower), *lower, pairs);
+				if (lower != upper && upper != status.end())
+					check(*std::prev(upper), *upper, pairs);
+			}
+	};
+
+	/**
+	 * Finds every intersecting pair of segments with a SegmentSweep.
+	 *
+	 * @return the number of pairs
+	 */
+	template<typename ValueType>
+	size_t intersections(const std::vector<LineSegment<2, ValueType>>& segments,
+		std::vector<SegmentPair>& pairs, ValueType tolerance = ValueType(1e-9))
+	{
+		SegmentSweep<ValueType> sweep;
+		return sweep.find(segments, pairs, tolerance);
+	}
+
+	/**
+	 * Finds every intersecting pair of segments by testing all of them, in
+	 * O(n^2). Gives the same pairs as intersections().
+	 *
+	 * @return the number of pairs
+	 */
+	template<typename ValueType>
+	size_t intersectionsBruteForce(
+		const std::vector<LineSegment<2, ValueType>>& segments,
+		std::vector<SegmentPair>& pairs, ValueType tolerance = ValueType(1e-9))
+	{
+		pairs.clear();
+		for (uint32_t i = 0; i < segments.size(); ++i)
+			for (uint32_t j = i + 1; j < segments.size(); ++j)
+			{
+				IntersectionType type = segmentIntersection(segments[i],
+					segments[j], tolerance);
+				if (type != NONE)
+					pairs.push_back({i, j, type});
+			}
+		return pairs.size();
+	}
+}
+
+#endif //PROJECTS_SEGMENTSWEEP_HPP
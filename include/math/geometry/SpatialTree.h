@@ -10,84 +10,794 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "../Parallel.hpp"
 #include "Vector.h"
 #include "Ray.hpp"
+#include "RayPacket.hpp"
 #include "GeometryCalculator.hpp"
 
 namespace flabs
 {
-	template<uint32_t DIM, class ExtendsVector, class VectorType = double>
+	/**
+	 * A 2^DIM-ary spatial tree (quadtree in 2D, octree in 3D). Every node
+	 * stores the axis aligned cube it covers, and elements are kept in the
+	 * leaves, up to BUCKET of them per leaf. A leaf that overflows splits into
+	 * children, except at the maximum depth, where it chains further buckets
+	 * instead, so clustered or repeated points cannot make the tree deep.
+	 *
+	 * Nodes and buckets live contiguously in pools and address each other by
+	 * 32 bit index, so the tree can be reused between frames with clear()
+	 * without allocating. A bucket stores the positions of its elements one
+	 * axis at a time, so queries compute the distances to a whole bucket with
+	 * SIMD and only touch the elements themselves for hits.
+	 *
+	 * Every element gets a Handle when added, which stays valid until it is
+	 * removed, so moving objects can be tracked with move() and remove() at a
+	 * cost that depends on what changed rather than on the size of the tree.
+	 * Nodes and buckets freed by removal are reused by later insertions.
+	 */
+	template<uint32_t DIM, class ExtendsVector, class VectorType = double,
+		uint32_t BUCKET = 8>
 	class SpatialTree
 	{
 		protected:
 			typedef Vector<DIM, VectorType> Vec;
 			typedef Ray<DIM, VectorType> Ry;
-			typedef SpatialTree<DIM, ExtendsVector, VectorType> ST;
-			ExtendsVector data;
+			typedef SpatialTree<DIM, ExtendsVector, VectorType, BUCKET> ST;
+			typedef Eigen::Array<VectorType, BUCKET, 1> Slots;
+			static constexpr uint32_t CHILD_COUNT = 1 << DIM;
+			static constexpr uint32_t NULL_INDEX  = 0xFFFFFFFF;
+			static constexpr uint32_t LEVELS      = DIM < 2 ? 32 : 64 / DIM;
+
+			/**
+			 * A subtree holding this many elements or fewer after a removal
+			 * is collapsed into one leaf. Half a bucket, so that a subtree
+			 * does not split and collapse in turn as one element comes and
+			 * goes.
+			 */
+			static constexpr uint32_t COLLAPSE = BUCKET / 2;
+
+			struct Node
+			{
+				Vec corner;
+				VectorType size;
+				uint32_t depth;
+				uint32_t parent;
+				uint32_t count;
+				uint32_t bucket;
+				uint32_t children[CHILD_COUNT];
+
+				Node(const Vec& corner, const VectorType& size, uint32_t depth,
+					uint32_t parent) :
+						corner(corner), size(size), depth(depth),
+						parent(parent), count(0), bucket(NULL_INDEX)
+				{
+					for (uint32_t i = 0; i < CHILD_COUNT; ++i)
+						children[i] = NULL_INDEX;
+				}
+
+				inline bool leaf() const
+				{
+					return bucket != NULL_INDEX;
+				}
+			};
+
+			/**
+			 * Up to BUCKET elements of a leaf: their positions, one column per
+			 * axis, and their handles. Buckets after the first of a leaf are
+			 * chained through next, and all but the last of them are full.
+			 */
+			struct Bucket
+			{
+				Eigen::Array<VectorType, BUCKET, DIM> positions;
+				uint32_t handles[BUCKET];
+				uint32_t count;
+				uint32_t node;
+				uint32_t next;
+
+				explicit Bucket(uint32_t node) :
+					count(0), node(node), next(NULL_INDEX)
+				{
+				}
+			};
+
+			/**
+			 * A point's Morton code, and its index in the input of build().
+			 */
+			struct MortonKey
+			{
+				uint64_t code;
+				uint32_t index;
+			};
+
+			/**
+			 * A subtree of build() that is emitted on a worker thread and
+			 * linked under child of parent afterwards.
+			 */
+			struct BuildTask
+			{
+				const MortonKey* begin;
+				const MortonKey* end;
+				uint32_t depth;
+				Vec corner;
+				VectorType size;
+				uint32_t parent;
+				uint32_t child;
+			};
+
 			Vec corner;
 			VectorType size;
-			const uint32_t CHILD_COUNT = 1 << DIM;
-			ST* children[CHILD_COUNT];
+			uint32_t maxDepth;
+			std::vector<Node> nodes;
+			std::vector<uint32_t> freeNodes;
+			std::vector<Bucket> buckets;
+			std::vector<uint32_t> freeBuckets;
+			std::vector<ExtendsVector> elements;
+			std::vector<uint32_t> handles;
+			std::vector<uint32_t> freeHandles;
 
 		public:
-			SpatialTree(const ExtendsVector& data, const Vec& corner, const VectorType& size) :
-					data(data), corner(corner), size(size)
+			/**
+			 * Identifies an element from insertion until removal.
+			 */
+			typedef uint32_t Handle;
+			static constexpr Handle NULL_HANDLE = NULL_INDEX;
+
+			/**
+			 * A query result: an element and its squared distance to the query
+			 * point. Ordered by distance so a vector of them can be used as a
+			 * heap.
+			 */
+			struct Neighbour
+			{
+				const ExtendsVector* element;
+				VectorType distanceSquared;
+
+				inline bool operator<(const Neighbour& neighbour) const
+				{
+					return distanceSquared < neighbour.distanceSquared;
+				}
+			};
+
+		public:
+			/**
+			 * @param maxDepth: the depth below which leaves no longer split,
+			 *        at most LEVELS
+			 */
+			SpatialTree(const Vec& corner, const VectorType& size,
+				uint32_t maxDepth = LEVELS) :
+					corner(corner), size(size),
+					maxDepth(std::min(maxDepth, LEVELS))
 			{
-				for (uint32_t i = 0; i < CHILD_COUNT; ++i)
-					children[i] = NULL;
+			}
+
+			SpatialTree(const ExtendsVector& data, const Vec& corner, const VectorType& size,
+				uint32_t maxDepth = LEVELS) :
+					corner(corner), size(size),
+					maxDepth(std::min(maxDepth, LEVELS))
+			{
+				elements.push_back(data);
+				handles.push_back(NULL_INDEX);
+				insertNoCheck(0, data, 0);
 			}
 
 			virtual ~SpatialTree()
 			{
-				for (uint32_t i = 0; i < CHILD_COUNT; ++i)
-					if (children[i] != NULL)
-						delete children[i];
 			}
 
-			inline bool contains(const Ry& ray)
+			inline bool contains(const Ry& ray) const
 			{
-				Vec t1 = (corner - ray.start) / ray.normalizedDirection;
-				Vec t2 = (corner + size - ray.start) / ray.normalizedDirection;
+				VectorType tmin, tmax;
+				return slab(corner, size, ray, tmin, tmax);
+			}
 
-				VectorType tmin = max(t1.min(), t2.min());
-				VectorType tmax = min(t1.max(), t2.max());
+			inline bool bounds(const Vec& point) const
+			{
+				return (corner.array() <= point.array()).all() &&
+					(point.array() < corner.array() + size).all();
+			}
 
-				return tmax >= tmin;
+			inline bool insert(const ExtendsVector& data)
+			{
+				Handle handle;
+				return insert(data, handle);
 			}
 
-			inline bool bounds(const Vec& point)
+			/**
+			 * @param handle: set to the handle of the new element
+			 * @return false if data is outside bounds()
+			 */
+			inline bool insert(const ExtendsVector& data, Handle& handle)
 			{
-				return corner <= point && point < (corner + size);
+				if (!bounds(data))
+					return false;
+
+				if (freeHandles.empty())
+				{
+					handle = elements.size();
+					elements.push_back(data);
+					handles.push_back(NULL_INDEX);
+				}
+				else
+				{
+					handle = freeHandles.back();
+					freeHandles.pop_back();
+					elements[handle] = data;
+				}
+				insertNoCheck(0, data, handle);
+				return true;
 			}
 
-			inline bool insert(const ExtendsVector& data)
+			/**
+			 * Removes an element. Its slot is filled with the last element of
+			 * its leaf, a leaf left empty is freed, and the highest subtree
+			 * that is left with no more than COLLAPSE elements is collapsed
+			 * into a single leaf.
+			 *
+			 * @return false if handle does not name an element
+			 */
+			bool remove(Handle handle)
 			{
-				if (bounds(data))
+				if (!valid(handle))
+					return false;
+
+				const uint32_t leaf = take(handle, NULL_INDEX);
+				handles[handle] = NULL_INDEX;
+				freeHandles.push_back(handle);
+				prune(leaf);
+				return true;
+			}
+
+			/**
+			 * Replaces an element with data, usually the same object at a new
+			 * position. If data is still inside the cube of the leaf holding
+			 * the element it is overwritten in place. Otherwise the element is
+			 * taken out as in remove() and inserted again below the nearest
+			 * ancestor whose cube contains data, which for small motions is
+			 * the parent or grandparent, so the cost grows with how far the
+			 * element moved rather than with the size of the tree.
+			 *
+			 * @return false, leaving the tree unchanged, if handle does not
+			 *         name an element or data is outside bounds()
+			 */
+			bool move(Handle handle, const ExtendsVector& data)
+			{
+				if (!valid(handle) || !bounds(data))
+					return false;
+
+				const uint32_t location = handles[handle];
+				const uint32_t leaf     = buckets[location / BUCKET].node;
+				elements[handle] = data;
+				if (contains(nodes[leaf], data))
 				{
-					insertNoCheck(data);
+					buckets[location / BUCKET].positions.row(location % BUCKET) =
+						position(data).transpose().array();
 					return true;
 				}
-				else
+
+				// The root contains everything in bounds(), so some strict
+				// ancestor does
+				uint32_t ancestor = nodes[leaf].parent;
+				while (!contains(nodes[ancestor], data))
+					ancestor = nodes[ancestor].parent;
+
+				take(handle, ancestor);
+				insertNoCheck(ancestor, data, handle);
+				prune(leaf);
+				return true;
+			}
+
+			/**
+			 * @return the element named by handle, or nullptr if there is none
+			 */
+			inline const ExtendsVector* element(Handle handle) const
+			{
+				return valid(handle) ? &elements[handle] : nullptr;
+			}
+
+			/**
+			 * Replaces the contents of the tree with points. Instead of
+			 * descending the tree once per point, the points are radix sorted
+			 * by Morton code, whose digits are the child indices of
+			 * getChildIndex() from the root down. Every subtree is then a
+			 * contiguous range of the sorted points and its children are found
+			 * by binary search, down to ranges that fit in a leaf. Encoding,
+			 * sorting and the subtrees below the top levels are spread across
+			 * threads.
+			 *
+			 * The tree has the same nodes as inserting the points one at a
+			 * time, only the order of elements within a leaf may differ.
+			 * points[i] gets handle i.
+			 *
+			 * @param points: the points, those outside bounds() are skipped
+			 * @param count: the number of points
+			 * @param threads: thread count, 0 for one per hardware thread
+			 * @return the number of points added
+			 */
+			size_t build(const ExtendsVector* points, size_t count,
+				unsigned threads = 0)
+			{
+				threads = threadCount(threads, count);
+				clear();
+
+				std::vector<MortonKey> keys(count);
+				std::vector<MortonKey> scratch;
+				std::vector<size_t>    valid(threads);
+				parallelFor(count, threads,
+					[&](size_t begin, size_t end, unsigned thread)
+					{
+						size_t last = begin;
+						for (size_t i = begin; i < end; ++i)
+							if (bounds(points[i]))
+								keys[last++] = {morton(points[i]),
+									(uint32_t) i};
+						valid[thread] = last - begin;
+					});
+
+				size_t total = 0;
+				for (unsigned thread = 0; thread < threads; ++thread)
+				{
+					auto begin = keys.begin() + count * thread / threads;
+					std::copy(begin, begin + valid[thread],
+						keys.begin() + total);
+					total += valid[thread];
+				}
+				keys.resize(total);
+				if (keys.empty())
+					return 0;
+				elements.assign(points, points + count);
+				handles.assign(count, NULL_INDEX);
+
+				radixSort(keys, scratch, LEVELS * DIM, threads,
+					[](const MortonKey& key)
+					{
+						return key.code;
+					});
+				nodes.reserve(2 * total / BUCKET + 1);
+				buckets.reserve(2 * total / BUCKET + 1);
+
+				if (threads == 1)
+				{
+					emit(points, keys.data(), keys.data() + total, 0, corner,
+						size, NULL_INDEX, maxDepth, nodes, buckets, 0, nullptr);
+					linkHandles(threads);
+					return total;
+				}
+
+				uint32_t splitDepth = 1;
+				for (size_t tasks = CHILD_COUNT; tasks < 4 * threads &&
+					splitDepth < maxDepth; tasks *= CHILD_COUNT)
+					++splitDepth;
+
+				std::vector<BuildTask> tasks;
+				emit(points, keys.data(), keys.data() + total, 0, corner, size,
+					NULL_INDEX, maxDepth, nodes, buckets, splitDepth, &tasks);
+
+				std::vector<std::vector<Node>>   subtrees(tasks.size());
+				std::vector<std::vector<Bucket>> subtreeBuckets(tasks.size());
+				std::atomic<size_t>              next(0);
+				parallelFor(threads, threads,
+					[&](size_t, size_t, unsigned)
+					{
+						for (size_t task; (task = next++) < tasks.size();)
+							emit(points, tasks[task].begin, tasks[task].end,
+								tasks[task].depth, tasks[task].corner,
+								tasks[task].size, NULL_INDEX, maxDepth,
+								subtrees[task], subtreeBuckets[task], 0,
+								nullptr);
+					});
+
+				for (size_t task = 0; task < tasks.size(); ++task)
+				{
+					const uint32_t offset       = nodes.size();
+					const uint32_t bucketOffset = buckets.size();
+					nodes[tasks[task].parent].children[tasks[task].child] =
+						offset;
+					nodes.insert(nodes.end(), subtrees[task].begin(),
+						subtrees[task].end());
+					buckets.insert(buckets.end(), subtreeBuckets[task].begin(),
+						subtreeBuckets[task].end());
+
+					nodes[offset].parent = tasks[task].parent;
+					for (size_t i = offset + 1; i < nodes.size(); ++i)
+						nodes[i].parent += offset;
+					for (size_t i = offset; i < nodes.size(); ++i)
+					{
+						if (nodes[i].bucket != NULL_INDEX)
+							nodes[i].bucket += bucketOffset;
+						for (uint32_t& child : nodes[i].children)
+							if (child != NULL_INDEX)
+								child += offset;
+					}
+					for (size_t i = bucketOffset; i < buckets.size(); ++i)
+					{
+						buckets[i].node += offset;
+						if (buckets[i].next != NULL_INDEX)
+							buckets[i].next += bucketOffset;
+					}
+				}
+				linkHandles(threads);
+				return total;
+			}
+
+			inline size_t build(const std::vector<ExtendsVector>& points,
+				unsigned threads = 0)
+			{
+				return build(points.data(), points.size(), threads);
+			}
+
+			/**
+			 * Finds the nearest element that lies within radius of the ray.
+			 * The elements of a leaf are tested together with SIMD.
+			 *
+			 * @param ray: the ray to cast
+			 * @param radius: the largest distance from the ray that counts as a
+			 *        hit
+			 * @param element: set to the element that was hit
+			 * @param distance: set to the distance along the ray to the
+			 *        element's projection onto it
+			 * @return true if an element was hit
+			 */
+			inline bool raycast(const Ry& ray, const VectorType& radius,
+				const ExtendsVector*& element, VectorType& distance) const
+			{
+				if (nodes.empty())
 					return false;
+
+				const VectorType radiusSquared = radius * radius;
+				auto leaf = [&](const Bucket& bucket, const Ry& ray,
+					uint32_t& best, VectorType& bestDistance)
+				{
+					passesNear(bucket, ray, radiusSquared, best, bestDistance);
+				};
+
+				uint32_t best = NULL_INDEX;
+				distance = std::numeric_limits<VectorType>::infinity();
+				raycast(0, ray, directionOrder(ray), radius, leaf, best,
+					distance);
+				if (best == NULL_INDEX)
+					return false;
+				element = &elements[best];
+				return true;
 			}
 
-		private:
-			void insertNoCheck(const ExtendsVector& data)
+			/**
+			 * Packet form of raycast(const Ry&, const VectorType&, ...). The
+			 * active lanes descend together, each node being slab tested and
+			 * each element distance tested for every lane at once, and a
+			 * subtree is skipped once no lane reaches it before its nearest
+			 * hit. Where only one lane is left, or when the lanes do not point
+			 * into the same octant, lanes are traced one at a time.
+			 *
+			 * @param packet: the rays to cast
+			 * @param radius: the largest distance from a ray that counts as a
+			 *        hit
+			 * @param elements: set to the element each lane hit, or nullptr
+			 * @param distances: set to each lane's distance to its hit, or
+			 *        infinity
+			 * @return the lanes that hit an element
+			 */
+			template<int WIDTH>
+			typename RayPacket<DIM, VectorType, WIDTH>::Mask raycast(
+				const RayPacket<DIM, VectorType, WIDTH>& packet,
+				const VectorType& radius,
+				const ExtendsVector* (&elements)[WIDTH],
+				typename RayPacket<DIM, VectorType, WIDTH>::Lanes& distances)
+				const
 			{
-				const uint32_t index = getChildIndex(data);
-				if (children[index] == NULL)
+				typedef RayPacket<DIM, VectorType, WIDTH> Packet;
+
+				const VectorType          radiusSquared = radius * radius;
+				typename Packet::Indices best =
+					Packet::Indices::Constant(NULL_INDEX);
+				distances.setConstant(
+					std::numeric_limits<VectorType>::infinity());
+
+				auto leaf = [&](const Bucket& bucket, const Ry& ray,
+					uint32_t& best, VectorType& bestDistance)
 				{
-					Vec corner(this->corner);
-					for (int i = 0; i < DIM; ++i)
-						if (data[i] - this->corner[i] >= size / 2)
-							corner[i] += size / 2;
-					children[index] = new ST(data, corner, size / 2);
+					passesNear(bucket, ray, radiusSquared, best, bestDistance);
+				};
+
+				const int lead = Packet::first(packet.active);
+				if (!nodes.empty() && lead >= 0)
+				{
+					if (packet.coherent())
+						raycast(0, packet, directionOrder(packet.ray(lead)),
+							radius, radiusSquared, leaf, best, distances);
+					else
+						for (int lane = 0; lane < WIDTH; ++lane)
+							if (packet.active(lane))
+							{
+								const Ry ray = packet.ray(lane);
+								raycast(0, ray, directionOrder(ray), radius,
+									leaf, best(lane), distances(lane));
+							}
 				}
-				else
-					children[index]->insertNoCheck(data);
+
+				for (int lane = 0; lane < WIDTH; ++lane)
+					elements[lane] = best(lane) == NULL_INDEX ? nullptr :
+						&this->elements[best(lane)];
+				return best != NULL_INDEX;
+			}
+
+			/**
+			 * Finds the nearest element accepted by hit. Nodes are visited
+			 * front to back along the ray and a node is skipped as soon as it
+			 * starts beyond the nearest confirmed hit, so only the nodes the
+			 * ray passes through before that hit are tested.
+			 *
+			 * @param ray: the ray to cast
+			 * @param margin: how far an element can reach outside of its node,
+			 *        node bounds are grown by this much before the slab test
+			 * @param hit: functor bool(const ExtendsVector&, const Ry&,
+			 *        VectorType& distance) that tests one element
+			 * @param element: set to the element that was hit
+			 * @param distance: set to the distance reported by hit
+			 * @return true if an element was hit
+			 */
+			template<class Hit>
+			bool raycast(const Ry& ray, const VectorType& margin, Hit&& hit,
+				const ExtendsVector*& element, VectorType& distance) const
+			{
+				if (nodes.empty())
+					return false;
+
+				auto leaf = [&](const Bucket& bucket, const Ry& ray,
+					uint32_t& best, VectorType& bestDistance)
+				{
+					for (uint32_t slot = 0; slot < bucket.count; ++slot)
+					{
+						VectorType d;
+						if (hit(elements[bucket.handles[slot]], ray, d) &&
+							d < bestDistance)
+						{
+							best         = bucket.handles[slot];
+							bestDistance = d;
+						}
+					}
+				};
+
+				uint32_t best = NULL_INDEX;
+				distance = std::numeric_limits<VectorType>::infinity();
+				raycast(0, ray, directionOrder(ray), margin, leaf, best,
+					distance);
+				if (best == NULL_INDEX)
+					return false;
+				element = &elements[best];
+				return true;
+			}
+
+			/**
+			 * Finds the k elements nearest to point. out is used as a bounded
+			 * max-heap while searching, and any node that is farther from the
+			 * point than the current k-th neighbour is skipped. Reusing out
+			 * across queries avoids allocating once its capacity reaches k.
+			 *
+			 * @param point: the query point
+			 * @param k: the number of neighbours to find
+			 * @param out: cleared, then filled with the neighbours, nearest
+			 *        first
+			 * @return the number of neighbours found, less than k only when
+			 *         the tree holds fewer than k elements
+			 */
+			size_t knn(const Vec& point, size_t k,
+				std::vector<Neighbour>& out) const
+			{
+				out.clear();
+				if (!nodes.empty() && k > 0)
+					knn(0, point, k, out);
+				std::sort_heap(out.begin(), out.end());
+				return out.size();
+			}
+
+			/**
+			 * Finds every element within r of point. Nodes farther than r from
+			 * the point are skipped.
+			 *
+			 * @param point: the query point
+			 * @param r: the search radius, inclusive
+			 * @param out: cleared, then filled with the neighbours in no
+			 *        particular order
+			 * @return the number of neighbours found
+			 */
+			size_t radius(const Vec& point, const VectorType& r,
+				std::vector<Neighbour>& out) const
+			{
+				out.clear();
+				if (!nodes.empty())
+					radius(0, point, r * r, out);
+				return out.size();
+			}
+
+			/**
+			 * Removes every element and invalidates every handle. The pools
+			 * keep their capacity, so refilling the tree does not allocate
+			 * again.
+			 */
+			inline void clear()
+			{
+				nodes.clear();
+				freeNodes.clear();
+				buckets.clear();
+				freeBuckets.clear();
+				elements.clear();
+				handles.clear();
+				freeHandles.clear();
+			}
+
+			inline void reserve(size_t count)
+			{
+				nodes.reserve(2 * count / BUCKET + 1);
+				buckets.reserve(2 * count / BUCKET + 1);
+				elements.reserve(count);
+				handles.reserve(count);
 			}
 
-			inline uint32_t getChildIndex(const Vec& point)
+			inline size_t count() const
+			{
+				return elements.size() - freeHandles.size();
+			}
+
+			inline bool empty() const
+			{
+				return nodes.empty();
+			}
+
+			/**
+			 * The number of nodes in use, internal ones and leaves.
+			 */
+			inline size_t nodeCount() const
+			{
+				return nodes.size() - freeNodes.size();
+			}
+
+			inline uint32_t getMaxDepth() const
+			{
+				return maxDepth;
+			}
+
+		protected:
+			static inline const Vec& position(const ExtendsVector& data)
+			{
+				return static_cast<const Vec&>(data);
+			}
+
+			/**
+			 * Slab test between the line of a ray and an axis aligned cube.
+			 * tmin and tmax are set to the distances along the ray where it
+			 * enters and leaves the cube. A ray starting on the plane of a
+			 * face it runs parallel to produces NaN for that axis, which
+			 * std::min/std::max discard, so that axis does not cull.
+			 */
+			static inline bool slab(const Vec& corner, const VectorType& size,
+				const Ry& ray, VectorType& tmin, VectorType& tmax)
+			{
+				Vec t1 = (corner - ray.start).cwiseQuotient(
+					ray.normalizedDirection);
+				Vec t2 = (corner.array() + size - ray.start.array()).matrix()
+					.cwiseQuotient(ray.normalizedDirection);
+
+				tmin = -std::numeric_limits<VectorType>::infinity();
+				tmax = std::numeric_limits<VectorType>::infinity();
+				for (uint32_t i = 0; i < DIM; ++i)
+				{
+					tmin = std::max(tmin, std::min(t1[i], t2[i]));
+					tmax = std::min(tmax, std::max(t1[i], t2[i]));
+				}
+
+				return tmax >= tmin;
+			}
+
+			/**
+			 * The child index of the octant a ray points into. Visiting
+			 * children i ^ order for increasing i goes front to back.
+			 */
+			static inline uint32_t directionOrder(const Ry& ray)
+			{
+				uint32_t order = 0;
+				for (uint32_t i = 0; i < DIM; ++i)
+				{
+					order <<= 1;
+
+					if (ray.normalizedDirection[i] < 0)
+						order |= 1;
+				}
+				return order;
+			}
+
+			/**
+			 * For every element of bucket, tests whether it lies ahead of a
+			 * ray within the radius whose square is given, and keeps the
+			 * nearest along the ray that is closer than bestDistance.
+			 */
+			static inline void passesNear(const Bucket& bucket, const Ry& ray,
+				const VectorType& radiusSquared, uint32_t& best,
+				VectorType& bestDistance)
+			{
+				Slots offset[DIM];
+				Slots distance = Slots::Zero();
+				for (uint32_t i = 0; i < DIM; ++i)
+				{
+					offset[i] = bucket.positions.col(i) - ray.start[i];
+					distance += offset[i] * ray.normalizedDirection[i];
+				}
+				Slots squaredNorm = Slots::Zero();
+				for (uint32_t i = 0; i < DIM; ++i)
+					squaredNorm += (offset[i] - ray.normalizedDirection[i] *
+						distance).square();
+
+				for (uint32_t slot = 0; slot < bucket.count; ++slot)
+					if (distance(slot) >= 0 && squaredNorm(slot) <=
+						radiusSquared && distance(slot) < bestDistance)
+					{
+						best         = bucket.handles[slot];
+						bestDistance = distance(slot);
+					}
+			}
+
+			/**
+			 * Squared distances from point to every slot of bucket.
+			 */
+			static inline Slots distancesSquared(const Bucket& bucket,
+				const Vec& point)
+			{
+				Slots distances = (bucket.positions.col(0) - point[0]).square();
+				for (uint32_t i = 1; i < DIM; ++i)
+					distances += (bucket.positions.col(i) - point[i]).square();
+				return distances;
+			}
+
+			/**
+			 * Squared distance from a point to the closest point of an axis
+			 * aligned cube, 0 if the point is inside it.
+			 */
+			static inline VectorType distanceSquared(const Vec& corner,
+				const VectorType& size, const Vec& point)
+			{
+				return (corner.array() - point.array()).cwiseMax(0)
+					.cwiseMax(point.array() - corner.array() - size)
+					.square().sum();
+			}
+
+			static inline bool contains(const Node& node, const Vec& point)
+			{
+				return (node.corner.array() <= point.array()).all() &&
+					(point.array() < node.corner.array() + node.size).all();
+			}
+
+			inline bool valid(Handle handle) const
+			{
+				return handle < handles.size() && handles[handle] != NULL_INDEX;
+			}
+
+			/**
+			 * Interleaves the bits of a point's position in the tree, LEVELS
+			 * bits per axis, so that each group of DIM bits from the top is
+			 * the getChildIndex() of the point one level further down.
+			 */
+			inline uint64_t morton(const Vec& point) const
+			{
+				const uint64_t   max   = (uint64_t(1) << LEVELS) - 1;
+				const VectorType scale = VectorType(max + 1) / size;
+
+				uint64_t quantized[DIM];
+				for (uint32_t i = 0; i < DIM; ++i)
+					quantized[i] = std::min(max, (uint64_t) std::max(
+						VectorType(0), (point[i] - corner[i]) * scale));
+
+				uint64_t code = 0;
+				for (uint32_t level = LEVELS; level-- > 0;)
+					for (uint32_t i = 0; i < DIM; ++i)
+						code = (code << 1) | ((quantized[i] >> level) & 1);
+				return code;
+			}
+
+			static inline uint32_t getChildIndex(const Node& node,
+				const Vec& point)
 			{
 				uint32_t index = 0;
 
@@ -95,12 +805,536 @@ namespace flabs
 				{
 					index <<= 1;
 
-					if (point.values[i] - corner.values[i] >= size / 2)
+					if (point[i] - node.corner[i] >= node.size / 2)
 						index |= 1;
 				}
 
 				return index;
 			}
+
+			/**
+			 * The corner of child index of a node.
+			 */
+			static inline Vec childCorner(const Node& node, uint32_t index)
+			{
+				const VectorType half = node.size / 2;
+				Vec corner(node.corner);
+				for (uint32_t i = 0; i < DIM; ++i)
+					if ((index >> (DIM - 1 - i)) & 1)
+						corner[i] += half;
+				return corner;
+			}
+
+		private:
+			template<class Leaf>
+			void raycast(uint32_t index, const Ry& ray, uint32_t order,
+				const VectorType& margin, Leaf& leaf, uint32_t& best,
+				VectorType& bestDistance) const
+			{
+				const Node& node = nodes[index];
+				VectorType tmin, tmax;
+				if (!slab((node.corner.array() - margin).matrix(),
+					node.size + 2 * margin, ray, tmin, tmax) || tmax < 0 ||
+					tmin > bestDistance)
+					return;
+
+				if (node.leaf())
+				{
+					for (uint32_t bucket = node.bucket; bucket != NULL_INDEX;
+						bucket = buckets[bucket].next)
+						leaf(buckets[bucket], ray, best, bestDistance);
+					return;
+				}
+
+				for (uint32_t i = 0; i < CHILD_COUNT; ++i)
+				{
+					const uint32_t child = node.children[i ^ order];
+					if (child != NULL_INDEX)
+						raycast(child, ray, order, margin, leaf, best,
+							bestDistance);
+				}
+			}
+
+			template<int WIDTH, class Leaf>
+			void raycast(uint32_t index,
+				const RayPacket<DIM, VectorType, WIDTH>& packet,
+				uint32_t order, const VectorType& margin,
+				const VectorType& radiusSquared, Leaf& leaf,
+				typename RayPacket<DIM, VectorType, WIDTH>::Indices& best,
+				typename RayPacket<DIM, VectorType, WIDTH>::Lanes& bestDistance)
+				const
+			{
+				typedef RayPacket<DIM, VectorType, WIDTH> Packet;
+				typedef typename Packet::Lanes            Lanes;
+				typedef typename Packet::Mask             Mask;
+
+				const Node& node = nodes[index];
+				Lanes tmin = Lanes::Constant(
+					-std::numeric_limits<VectorType>::infinity());
+				Lanes tmax = Lanes::Constant(
+					std::numeric_limits<VectorType>::infinity());
+				const Mask lanes = packet.active &&
+					packet.slab((node.corner.array() - margin).matrix(),
+						(node.corner.array() + node.size + margin).matrix(),
+						tmin, tmax) && tmax >= 0 && tmin <= bestDistance;
+
+				const int count = lanes.count();
+				if (count == 0)
+					return;
+				if (count == 1)
+				{
+					const int lane = Packet::first(lanes);
+					raycast(index, packet.ray(lane), order, margin, leaf,
+						best(lane), bestDistance(lane));
+					return;
+				}
+
+				if (!node.leaf())
+				{
+					for (uint32_t i = 0; i < CHILD_COUNT; ++i)
+					{
+						const uint32_t child = node.children[i ^ order];
+						if (child != NULL_INDEX)
+							raycast(child, packet, order, margin, radiusSquared,
+								leaf, best, bestDistance);
+					}
+					return;
+				}
+
+				// passesNear() for every lane, one element at a time
+				for (uint32_t b = node.bucket; b != NULL_INDEX;
+					b = buckets[b].next)
+				{
+					const Bucket& bucket = buckets[b];
+					for (uint32_t slot = 0; slot < bucket.count; ++slot)
+					{
+						Lanes distance = Lanes::Zero();
+						Lanes offset[DIM];
+						for (uint32_t i = 0; i < DIM; ++i)
+						{
+							offset[i] = bucket.positions(slot, i) -
+								packet.start.col(i);
+							distance += offset[i] * packet.direction.col(i);
+						}
+						Lanes squaredNorm = Lanes::Zero();
+						for (uint32_t i = 0; i < DIM; ++i)
+							squaredNorm += (offset[i] - packet.direction.col(i) *
+								distance).square();
+
+						const Mask closer = lanes && distance >= 0 &&
+							squaredNorm <= radiusSquared &&
+							distance < bestDistance;
+						best         = closer.select(bucket.handles[slot], best);
+						bestDistance = closer.select(distance, bestDistance);
+					}
+				}
+			}
+
+			void knn(uint32_t index, const Vec& point, size_t k,
+				std::vector<Neighbour>& out) const
+			{
+				const Node& node = nodes[index];
+				if (out.size() == k && distanceSquared(node.corner, node.size,
+					point) > out.front().distanceSquared)
+					return;
+
+				if (node.leaf())
+				{
+					for (uint32_t b = node.bucket; b != NULL_INDEX;
+						b = buckets[b].next)
+					{
+						const Bucket& bucket    = buckets[b];
+						const Slots   distances = distancesSquared(bucket, point);
+						for (uint32_t slot = 0; slot < bucket.count; ++slot)
+						{
+							const Neighbour neighbour = {
+								&elements[bucket.handles[slot]], distances(slot)};
+							if (out.size() < k)
+							{
+								out.push_back(neighbour);
+								std::push_heap(out.begin(), out.end());
+							}
+							else if (neighbour < out.front())
+							{
+								std::pop_heap(out.begin(), out.end());
+								out.back() = neighbour;
+								std::push_heap(out.begin(), out.end());
+							}
+						}
+					}
+					return;
+				}
+
+				const uint32_t order = getChildIndex(node, point);
+				for (uint32_t i = 0; i < CHILD_COUNT; ++i)
+				{
+					const uint32_t child = node.children[i ^ order];
+					if (child != NULL_INDEX)
+						knn(child, point, k, out);
+				}
+			}
+
+			void radius(uint32_t index, const Vec& point,
+				const VectorType& rSquared, std::vector<Neighbour>& out) const
+			{
+				const Node& node = nodes[index];
+				if (distanceSquared(node.corner, node.size, point) > rSquared)
+					return;
+
+				if (node.leaf())
+				{
+					for (uint32_t b = node.bucket; b != NULL_INDEX;
+						b = buckets[b].next)
+					{
+						const Bucket& bucket    = buckets[b];
+						const Slots   distances = distancesSquared(bucket, point);
+						for (uint32_t slot = 0; slot < bucket.count; ++slot)
+							if (distances(slot) <= rSquared)
+								out.push_back({&elements[bucket.handles[slot]],
+									distances(slot)});
+					}
+					return;
+				}
+
+				for (uint32_t i = 0; i < CHILD_COUNT; ++i)
+				{
+					const uint32_t child = node.children[i];
+					if (child != NULL_INDEX)
+						radius(child, point, rSquared, out);
+				}
+			}
+
+			/**
+			 * Appends the subtree of the sorted range [begin, end) to nodes
+			 * and buckets and returns the index of its root. A range that fits
+			 * in a bucket, or reaches maxDepth, becomes a leaf. Subtrees at
+			 * splitDepth are not emitted but added to tasks, when tasks is
+			 * given. Slots take the input index of their point as handle.
+			 */
+			static uint32_t emit(const ExtendsVector* points,
+				const MortonKey* begin, const MortonKey* end, uint32_t depth,
+				const Vec& corner, const VectorType& size, uint32_t parent,
+				uint32_t maxDepth, std::vector<Node>& nodes,
+				std::vector<Bucket>& buckets, uint32_t splitDepth,
+				std::vector<BuildTask>* tasks)
+			{
+				const uint32_t index = nodes.size();
+				nodes.emplace_back(corner, size, depth, parent);
+				nodes[index].count = end - begin;
+
+				if (size_t(end - begin) <= BUCKET || depth >= maxDepth)
+				{
+					uint32_t previous = NULL_INDEX;
+					while (begin != end)
+					{
+						const uint32_t bucket = buckets.size();
+						buckets.emplace_back(index);
+						if (previous == NULL_INDEX)
+							nodes[index].bucket = bucket;
+						else
+							buckets[previous].next = bucket;
+
+						Bucket& b = buckets[bucket];
+						for (; begin != end && b.count < BUCKET; ++begin)
+						{
+							b.positions.row(b.count) =
+								position(points[begin->index]).transpose()
+								.array();
+							b.handles[b.count++] = begin->index;
+						}
+						previous = bucket;
+					}
+					return index;
+				}
+
+				const uint32_t   shift = DIM * (LEVELS - 1 - depth);
+				const VectorType half  = size / 2;
+				while (begin != end)
+				{
+					const uint32_t child =
+						(begin->code >> shift) & (CHILD_COUNT - 1);
+					const MortonKey* last = std::partition_point(begin, end,
+						[&](const MortonKey& key)
+						{
+							return ((key.code >> shift) & (CHILD_COUNT - 1)) ==
+								child;
+						});
+
+					const Vec lower = childCorner(nodes[index], child);
+					if (tasks && depth + 1 == splitDepth)
+						tasks->push_back({begin, last, depth + 1, lower, half,
+							index, child});
+					else
+					{
+						const uint32_t node = emit(points, begin, last,
+							depth + 1, lower, half, index, maxDepth, nodes,
+							buckets, splitDepth, tasks);
+						nodes[index].children[child] = node;
+					}
+					begin = last;
+				}
+				return index;
+			}
+
+			/**
+			 * Points the handle of every built slot at it, and frees the
+			 * handles of the points build() skipped.
+			 */
+			void linkHandles(unsigned threads)
+			{
+				parallelFor(buckets.size(), threads,
+					[&](size_t begin, size_t end, unsigned)
+					{
+						for (size_t b = begin; b < end; ++b)
+							for (uint32_t slot = 0; slot < buckets[b].count;
+								++slot)
+								handles[buckets[b].handles[slot]] =
+									b * BUCKET + slot;
+					});
+				for (size_t handle = handles.size(); handle-- > 0;)
+					if (handles[handle] == NULL_INDEX)
+						freeHandles.push_back(handle);
+			}
+
+			uint32_t allocateNode(const Vec& corner, const VectorType& size,
+				uint32_t depth, uint32_t parent)
+			{
+				if (freeNodes.empty())
+				{
+					nodes.emplace_back(corner, size, depth, parent);
+					return nodes.size() - 1;
+				}
+				const uint32_t index = freeNodes.back();
+				freeNodes.pop_back();
+				nodes[index] = Node(corner, size, depth, parent);
+				return index;
+			}
+
+			uint32_t allocateBucket(uint32_t node)
+			{
+				if (freeBuckets.empty())
+				{
+					buckets.emplace_back(node);
+					return buckets.size() - 1;
+				}
+				const uint32_t index = freeBuckets.back();
+				freeBuckets.pop_back();
+				buckets[index] = Bucket(node);
+				return index;
+			}
+
+			/**
+			 * Adds an empty leaf as child index of parent.
+			 */
+			uint32_t addLeaf(uint32_t parent, uint32_t index)
+			{
+				const uint32_t child = allocateNode(childCorner(nodes[parent],
+					index), nodes[parent].size / 2, nodes[parent].depth + 1,
+					parent);
+				nodes[child].bucket          = allocateBucket(child);
+				nodes[parent].children[index] = child;
+				return child;
+			}
+
+			/**
+			 * Puts an element in the last bucket of a leaf, chaining a new
+			 * bucket if it is full. Does not change counts.
+			 */
+			void append(uint32_t node, const Vec& point, Handle handle)
+			{
+				uint32_t bucket = nodes[node].bucket;
+				while (buckets[bucket].next != NULL_INDEX)
+					bucket = buckets[bucket].next;
+				if (buckets[bucket].count == BUCKET)
+				{
+					const uint32_t next = allocateBucket(node);
+					buckets[bucket].next = next;
+					bucket               = next;
+				}
+
+				Bucket& b = buckets[bucket];
+				b.positions.row(b.count) = point.transpose().array();
+				b.handles[b.count]       = handle;
+				handles[handle]          = bucket * BUCKET + b.count++;
+			}
+
+			/**
+			 * Inserts an element below node, which must contain it, counting
+			 * it in node and every node below on its way down. A leaf that
+			 * would hold more than BUCKET elements is split first, unless it
+			 * is at maxDepth.
+			 */
+			void insertNoCheck(uint32_t node, const Vec& point, Handle handle)
+			{
+				if (nodes.empty())
+				{
+					node = allocateNode(corner, size, 0, NULL_INDEX);
+					nodes[node].bucket = allocateBucket(node);
+				}
+
+				while (true)
+				{
+					++nodes[node].count;
+					if (nodes[node].leaf())
+					{
+						if (nodes[node].count <= BUCKET ||
+							nodes[node].depth >= maxDepth)
+						{
+							append(node, point, handle);
+							return;
+						}
+						split(node);
+					}
+
+					const uint32_t index = getChildIndex(nodes[node], point);
+					uint32_t       child = nodes[node].children[index];
+					if (child == NULL_INDEX)
+						child = addLeaf(node, index);
+					node = child;
+				}
+			}
+
+			/**
+			 * Turns a leaf below maxDepth, which therefore has a single
+			 * bucket, into an internal node with its elements moved into
+			 * child leaves.
+			 */
+			void split(uint32_t node)
+			{
+				const Bucket bucket = buckets[nodes[node].bucket];
+				freeBuckets.push_back(nodes[node].bucket);
+				nodes[node].bucket = NULL_INDEX;
+
+				for (uint32_t slot = 0; slot < bucket.count; ++slot)
+				{
+					const Vec point =
+						bucket.positions.row(slot).transpose().matrix();
+					const uint32_t index = getChildIndex(nodes[node], point);
+					uint32_t       child = nodes[node].children[index];
+					if (child == NULL_INDEX)
+						child = addLeaf(node, index);
+					++nodes[child].count;
+					append(child, point, bucket.handles[slot]);
+				}
+			}
+
+			/**
+			 * Takes the element of handle out of its leaf, moving the last
+			 * element of the leaf into its slot, and uncounts it from the leaf
+			 * up to and including until, or up to the root if until is
+			 * NULL_INDEX. The handle itself is left to the caller.
+			 *
+			 * @return the leaf
+			 */
+			uint32_t take(Handle handle, uint32_t until)
+			{
+				const uint32_t location = handles[handle];
+				const uint32_t bucket   = location / BUCKET;
+				const uint32_t slot     = location % BUCKET;
+				const uint32_t leaf     = buckets[bucket].node;
+
+				uint32_t previous = NULL_INDEX;
+				uint32_t last     = nodes[leaf].bucket;
+				while (buckets[last].next != NULL_INDEX)
+				{
+					previous = last;
+					last     = buckets[last].next;
+				}
+
+				Bucket&        from  = buckets[last];
+				const uint32_t moved = --from.count;
+				if (last != bucket || moved != slot)
+				{
+					buckets[bucket].positions.row(slot) =
+						from.positions.row(moved);
+					buckets[bucket].handles[slot] = from.handles[moved];
+					handles[from.handles[moved]]  = location;
+				}
+				if (from.count == 0 && previous != NULL_INDEX)
+				{
+					buckets[previous].next = NULL_INDEX;
+					freeBuckets.push_back(last);
+				}
+
+				for (uint32_t node = leaf; node != NULL_INDEX;
+					node = nodes[node].parent)
+				{
+					--nodes[node].count;
+					if (node == until)
+						break;
+				}
+				return leaf;
+			}
+
+			/**
+			 * Tidies up after take() from a leaf: frees the leaf and any
+			 * ancestors left empty, then collapses the highest ancestor with
+			 * no more than COLLAPSE elements into a single leaf.
+			 */
+			void prune(uint32_t node)
+			{
+				while (nodes[node].count == 0)
+				{
+					const uint32_t parent = nodes[node].parent;
+					if (parent == NULL_INDEX)
+					{
+						clear();
+						return;
+					}
+					if (nodes[node].leaf())
+						freeBuckets.push_back(nodes[node].bucket);
+					for (uint32_t& child : nodes[parent].children)
+						if (child == node)
+							child = NULL_INDEX;
+					freeNodes.push_back(node);
+					node = parent;
+				}
+
+				uint32_t top = NULL_INDEX;
+				for (; node != NULL_INDEX && nodes[node].count <= COLLAPSE;
+					node = nodes[node].parent)
+					top = node;
+				if (top != NULL_INDEX && !nodes[top].leaf())
+				{
+					const uint32_t bucket = allocateBucket(top);
+					gather(top, bucket);
+					nodes[top].bucket = bucket;
+				}
+			}
+
+			/**
+			 * Moves every element below node into bucket, and frees the nodes
+			 * and buckets they were in.
+			 */
+			void gather(uint32_t node, uint32_t bucket)
+			{
+				for (uint32_t& child : nodes[node].children)
+				{
+					if (child == NULL_INDEX)
+						continue;
+
+					if (nodes[child].leaf())
+						for (uint32_t b = nodes[child].bucket; b != NULL_INDEX;
+							b = buckets[b].next)
+						{
+							Bucket&       to   = buckets[bucket];
+							const Bucket& from = buckets[b];
+							for (uint32_t slot = 0; slot < from.count; ++slot)
+							{
+								to.positions.row(to.count) =
+									from.positions.row(slot);
+								to.handles[to.count] = from.handles[slot];
+								handles[from.handles[slot]] =
+									bucket * BUCKET + to.count++;
+							}
+							freeBuckets.push_back(b);
+						}
+					else
+						gather(child, bucket);
+					freeNodes.push_back(child);
+					child = NULL_INDEX;
+				}
+			}
 	};
 }
 
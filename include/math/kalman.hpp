@@ -1,14 +1,1001 @@
-#include <Eigen/Eigen3.hpp>
+//
+// Created on 10/17/2026.
+//
 
-template<uint8_t Dim>
+#ifndef PROJECTS_KALMAN_HPP
+#define PROJECTS_KALMAN_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <type_traits>
+#include <Eigen/Eigen>
+#include <unsupported/Eigen/AutoDiff>
+#include "Math.hpp"
+#include "Parallel.hpp"
+
+namespace flabs
+{
+/**
+ * A linear Kalman filter. Every matrix is fixed-size, so predict() and
+ * update() never allocate.
+ *
+ * @tparam StateDim: the number of state variables
+ * @tparam MeasurementDim: the number of measured variables
+ * @tparam ValueType: the scalar type
+ */
+template<uint32_t StateDim, uint32_t MeasurementDim = StateDim,
+	class ValueType = double>
 struct kalman
 {
 public:
-    using my_t = kalman<Dim>;
-    using Mat = eigen::matrix<Dim>;
+	using my_t           = kalman<StateDim, MeasurementDim, ValueType>;
+	using State          = Eigen::Matrix<ValueType, StateDim, 1>;
+	using Mat            = Eigen::Matrix<ValueType, StateDim, StateDim>;
+	using Measurement    = Eigen::Matrix<ValueType, MeasurementDim, 1>;
+	using MeasurementMat = Eigen::Matrix<ValueType, MeasurementDim, StateDim>;
+	using MeasurementCov =
+		Eigen::Matrix<ValueType, MeasurementDim, MeasurementDim>;
+	using Gain           = Eigen::Matrix<ValueType, StateDim, MeasurementDim>;
+
+public:
+	/**
+	 * The state estimate x, and its covariance P
+	 */
+	State state;
+	Mat   covariance;
+
+	/**
+	 * The process model F, and its noise covariance Q
+	 */
+	Mat transition;
+	Mat processNoise;
+
+	/**
+	 * The measurement model H, and its noise covariance R
+	 */
+	MeasurementMat observation;
+	MeasurementCov measurementNoise;
+
+public:
+	kalman()
+	{
+		state.setZero();
+		covariance.setIdentity();
+		transition.setIdentity();
+		processNoise.setZero();
+		observation.setIdentity();
+		measurementNoise.setIdentity();
+	}
+
+	/**
+	 * Propagates the state through the process model.
+	 * x = F x, P = F P F' + Q
+	 */
+	inline my_t& predict()
+	{
+		state = transition * state;
+		covariance = transition * covariance * transition.transpose() +
+			processNoise;
+		return *this;
+	}
+
+	/**
+	 * Corrects the state with a measurement. The gain is solved through a
+	 * Cholesky factorisation of the innovation covariance instead of an
+	 * explicit inverse, and the covariance is updated in Joseph form,
+	 * P = (I - K H) P (I - K H)' + K R K', which keeps it symmetric and
+	 * positive semi-definite despite rounding.
+	 *
+	 * @param measurement: the measurement z
+	 * @return false, leaving the filter unchanged, if the innovation
+	 *         covariance is not positive definite
+	 */
+	bool update(const Measurement& measurement)
+	{
+		const Measurement    innovation =
+								 measurement - observation * state;
+		const MeasurementMat observedCovariance = observation * covariance;
+		const MeasurementCov innovationCovariance =
+								 observedCovariance * observation.transpose() +
+								 measurementNoise;
+
+		const Eigen::LLT<MeasurementCov> llt(innovationCovariance);
+		if (llt.info() != Eigen::Success)
+			return false;
+
+		// S is symmetric, so K' = S^-1 H P
+		const Gain gain = llt.solve(observedCovariance).transpose();
+		const Mat  correction = Mat::Identity() - gain * observation;
+
+		state += gain * innovation;
+		covariance = correction * covariance * correction.transpose() +
+			gain * measurementNoise * gain.transpose();
+		return true;
+	}
+};
+
+/**
+ * A square-root linear Kalman filter. Instead of the covariance P it carries
+ * a factor S with P = S S', and both steps rebuild S from an orthogonal
+ * (Householder QR) triangularisation. P stays symmetric positive
+ * semi-definite by construction, and S needs half the dynamic range of P,
+ * so the filter stays stable in float. Every matrix is fixed-size, so
+ * predict() and update() never allocate.
+ *
+ * @tparam StateDim: the number of state variables
+ * @tparam MeasurementDim: the number of measured variables
+ * @tparam ValueType: the scalar type
+ */
+template<uint32_t StateDim, uint32_t MeasurementDim = StateDim,
+	class ValueType = float>
+struct squareRootKalman
+{
+public:
+	using my_t           = squareRootKalman<StateDim, MeasurementDim,
+		ValueType>;
+	using State          = Eigen::Matrix<ValueType, StateDim, 1>;
+	using Mat            = Eigen::Matrix<ValueType, StateDim, StateDim>;
+	using Measurement    = Eigen::Matrix<ValueType, MeasurementDim, 1>;
+	using MeasurementMat = Eigen::Matrix<ValueType, MeasurementDim, StateDim>;
+	using MeasurementCov =
+		Eigen::Matrix<ValueType, MeasurementDim, MeasurementDim>;
+
+public:
+	/**
+	 * The state estimate x, and a factor S of its covariance, P = S S'
+	 */
+	State state;
+	Mat   covarianceFactor;
+
+	/**
+	 * The process model F, and a factor of its noise covariance, Q = Qs Qs'
+	 */
+	Mat transition;
+	Mat processNoiseFactor;
+
+	/**
+	 * The measurement model H, and a factor of its noise covariance,
+	 * R = Rs Rs'
+	 */
+	MeasurementMat observation;
+	MeasurementCov measurementNoiseFactor;
+
+private:
+	static constexpr uint32_t AugmentedDim = StateDim + MeasurementDim;
+
+public:
+	squareRootKalman()
+	{
+		state.setZero();
+		covarianceFactor.setIdentity();
+		transition.setIdentity();
+		processNoiseFactor.setZero();
+		observation.setIdentity();
+		measurementNoiseFactor.setIdentity();
+	}
+
+	/**
+	 * Returns the covariance, P = S S'
+	 */
+	inline Mat covariance() const
+	{
+		return covarianceFactor * covarianceFactor.transpose();
+	}
+
+	/**
+	 * Sets the covariance through its Cholesky factor.
+	 *
+	 * @return false if covariance is not positive definite
+	 */
+	bool setCovariance(const Mat& covariance)
+	{
+		const Eigen::LLT<Mat> llt(covariance);
+		if (llt.info() != Eigen::Success)
+			return false;
+		covarianceFactor = llt.matrixL();
+		return true;
+	}
+
+	/**
+	 * Propagates the state through the process model. The new factor is the
+	 * triangularisation of [F S, Qs], whose outer product is F P F' + Q.
+	 */
+	my_t& predict()
+	{
+		Eigen::Matrix<ValueType, 2 * StateDim, StateDim> preArray;
+		preArray.template topRows<StateDim>() =
+			(transition * covarianceFactor).transpose();
+		preArray.template bottomRows<StateDim>() =
+			processNoiseFactor.transpose();
+
+		state = transition * state;
+		covarianceFactor = lowerFactor<2 * StateDim, StateDim>(preArray);
+		return *this;
+	}
+
+	/**
+	 * Corrects the state with a measurement. The pre-array
+	 * [Rs, H S; 0, S] is triangularised into [Ws, 0; Kb, S+], where
+	 * Ws Ws' is the innovation covariance, K = Kb Ws^-1 is the gain, and S+
+	 * is the updated factor.
+	 *
+	 * @param measurement: the measurement z
+	 * @return false, leaving the filter unchanged, if the innovation
+	 *         covariance is singular
+	 */
+	bool update(const Measurement& measurement)
+	{
+		Eigen::Matrix<ValueType, AugmentedDim, AugmentedDim> preArray;
+		preArray.template topLeftCorner<MeasurementDim, MeasurementDim>() =
+			measurementNoiseFactor.transpose();
+		preArray.template topRightCorner<MeasurementDim, StateDim>().setZero();
+		preArray.template bottomLeftCorner<StateDim, MeasurementDim>() =
+			(observation * covarianceFactor).transpose();
+		preArray.template bottomRightCorner<StateDim, StateDim>() =
+			covarianceFactor.transpose();
+
+		const Eigen::Matrix<ValueType, AugmentedDim, AugmentedDim> postArray =
+			lowerFactor<AugmentedDim, AugmentedDim>(preArray);
+		const MeasurementCov innovationFactor = postArray.template
+			topLeftCorner<MeasurementDim, MeasurementDim>();
+		if ((innovationFactor.diagonal().array() == 0).any())
+			return false;
+
+		state += postArray.template
+			bottomLeftCorner<StateDim, MeasurementDim>() *
+			innovationFactor.template triangularView<Eigen::Lower>().solve(
+				measurement - observation * state);
+		covarianceFactor = postArray.template
+			bottomRightCorner<StateDim, StateDim>();
+		return true;
+	}
+
+private:
+	/**
+	 * Given A' (Rows x Cols), returns the lower triangular L with L L' = A A',
+	 * with a non-negative diagonal.
+	 */
+	template<int Rows, int Cols>
+	static Eigen::Matrix<ValueType, Cols, Cols> lowerFactor(
+		const Eigen::Matrix<ValueType, Rows, Cols>& transposed)
+	{
+		const Eigen::HouseholderQR<Eigen::Matrix<ValueType, Rows, Cols>> qr(
+			transposed);
+		Eigen::Matrix<ValueType, Cols, Cols> lower = qr.matrixQR()
+			.template topRows<Cols>().template triangularView<Eigen::Upper>()
+			.transpose();
+		for (int i = 0; i < Cols; ++i)
+			if (lower(i, i) < 0)
+				lower.col(i) = -lower.col(i);
+		return lower;
+	}
+};
+
+/**
+ * A bank of linear Kalman filters that share one process and measurement
+ * model. States and covariances are stored as structures of arrays, one row
+ * per track and one column per matrix entry, so every step of predict() and
+ * update() is an array operation across tracks. Tracks are processed in
+ * blocks of LANES rows held in stack arrays, so no step allocates.
+ *
+ * @tparam StateDim: the number of state variables
+ * @tparam MeasurementDim: the number of measured variables
+ * @tparam ValueType: the scalar type
+ */
+template<uint32_t StateDim, uint32_t MeasurementDim = StateDim,
+	class ValueType = double>
+struct kalmanBank
+{
+public:
+	using my_t           = kalmanBank<StateDim, MeasurementDim, ValueType>;
+	using Filter         = kalman<StateDim, MeasurementDim, ValueType>;
+	using Mat            = typename Filter::Mat;
+	using MeasurementMat = typename Filter::MeasurementMat;
+	using MeasurementCov = typename Filter::MeasurementCov;
+	using States         = Eigen::Array<ValueType, Eigen::Dynamic, StateDim>;
+	using Covariances    =
+		Eigen::Array<ValueType, Eigen::Dynamic, StateDim * StateDim>;
+	using Measurements   =
+		Eigen::Array<ValueType, Eigen::Dynamic, MeasurementDim>;
+	using Mask           = Eigen::Array<bool, Eigen::Dynamic, 1>;
+
+	static constexpr uint32_t LANES = 32;
+
+public:
+	/**
+	 * Row t holds track t. Column r + c * StateDim of covariances holds
+	 * entry (r, c) of the covariance.
+	 */
+	States      states;
+	Covariances covariances;
+
+	/**
+	 * The process model F and noise Q, and the measurement model H and noise
+	 * R, shared by every track
+	 */
+	Mat            transition;
+	Mat            processNoise;
+	MeasurementMat observation;
+	MeasurementCov measurementNoise;
 
 private:
+	template<uint32_t Rows, uint32_t Cols>
+	using Lanes = Eigen::Array<ValueType, Eigen::Dynamic, Rows * Cols,
+		Eigen::ColMajor, LANES, Rows * Cols>;
 
 public:
+	kalmanBank(size_t tracks = 0)
+	{
+		Filter filter;
+		transition       = filter.transition;
+		processNoise     = filter.processNoise;
+		observation      = filter.observation;
+		measurementNoise = filter.measurementNoise;
+		resize(tracks);
+	}
+
+	inline size_t size() const
+	{
+		return states.rows();
+	}
+
+	/**
+	 * Resizes the bank, new tracks start from a default kalman.
+	 */
+	void resize(size_t tracks)
+	{
+		const size_t old = size();
+		states.conservativeResize(tracks, StateDim);
+		covariances.conservativeResize(tracks, StateDim * StateDim);
+		for (size_t track = old; track < tracks; ++track)
+			set(track, Filter());
+	}
+
+	/**
+	 * Copies the state and covariance of a filter into a track.
+	 */
+	inline void set(size_t track, const Filter& filter)
+	{
+		states.row(track) = filter.state.transpose().array();
+		covariances.row(track) = Eigen::Map<const Eigen::Array<ValueType, 1,
+			StateDim * StateDim>>(filter.covariance.data());
+	}
+
+	/**
+	 * Returns a track as a kalman with the bank's models.
+	 */
+	inline Filter get(size_t track) const
+	{
+		Filter filter;
+		filter.state = states.row(track).transpose().matrix();
+		Eigen::Map<Eigen::Array<ValueType, 1, StateDim * StateDim>>(
+			filter.covariance.data()) = covariances.row(track);
+		filter.transition       = transition;
+		filter.processNoise     = processNoise;
+		filter.observation      = observation;
+		filter.measurementNoise = measurementNoise;
+		return filter;
+	}
+
+	/**
+	 * Predicts every track, see kalman::predict().
+	 *
+	 * @param threads: thread count, 0 for one per hardware thread
+	 */
+	my_t& predict(unsigned threads = 1)
+	{
+		forEachBlock(threads, [this](size_t begin, size_t count)
+		{
+			predict(begin, count);
+		});
+		return *this;
+	}
+
+	/**
+	 * Updates the tracks whose mask is set with their row of measurements,
+	 * see kalman::update(). The others, and any track whose innovation
+	 * covariance is not positive definite, are left unchanged.
+	 *
+	 * @param measurements: one row per track
+	 * @param mask: which tracks were measured
+	 * @param threads: thread count, 0 for one per hardware thread
+	 */
+	my_t& update(const Measurements& measurements, const Mask& mask,
+		unsigned threads = 1)
+	{
+		forEachBlock(threads, [&](size_t begin, size_t count)
+		{
+			update(begin, count, measurements, mask);
+		});
+		return *this;
+	}
+
+private:
+	static constexpr inline uint32_t at(uint32_t row, uint32_t col,
+		uint32_t rows)
+	{
+		return row + col * rows;
+	}
+
+	/**
+	 * Splits the tracks into one contiguous range per thread, and each range
+	 * into blocks of at most LANES tracks.
+	 */
+	template<class Function>
+	void forEachBlock(unsigned threads, Function&& function)
+	{
+		const size_t blocks = (size() + LANES - 1) / LANES;
+		parallelFor(blocks, threadCount(threads, blocks),
+			[&](size_t begin, size_t end, unsigned)
+			{
+				for (size_t block = begin; block < end; ++block)
+					function(block * LANES,
+						std::min<size_t>(LANES, size() - block * LANES));
+			});
+	}
+
+	void predict(size_t begin, size_t count)
+	{
+		const uint32_t S = StateDim;
+		auto           x = states.middleRows(begin, count);
+		auto           P = covariances.middleRows(begin, count);
+
+		Lanes<StateDim, 1>        state(count, S);
+		Lanes<StateDim, StateDim> product(count, S * S);
+		state.setZero();
+		product.setZero();
+
+		// x = F x, T = F P
+		for (uint32_t a = 0; a < S; ++a)
+			for (uint32_t i = 0; i < S; ++i)
+				if (transition(a, i) != 0)
+				{
+					state.col(a) += transition(a, i) * x.col(i);
+					for (uint32_t b = 0; b < S; ++b)
+						product.col(at(a, b, S)) +=
+							transition(a, i) * P.col(at(i, b, S));
+				}
+		x = state;
+
+		// P = T F' + Q
+		for (uint32_t a = 0; a < S; ++a)
+			for (uint32_t b = 0; b < S; ++b)
+			{
+				auto entry = P.col(at(a, b, S));
+				entry.setConstant(processNoise(a, b));
+				for (uint32_t j = 0; j < S; ++j)
+					if (transition(b, j) != 0)
+						entry += transition(b, j) * product.col(at(a, j, S));
+			}
+	}
+
+	void update(size_t begin, size_t count, const Measurements& measurements,
+		const Mask& mask)
+	{
+		const uint32_t S = StateDim;
+		const uint32_t M = MeasurementDim;
+		auto           x = states.middleRows(begin, count);
+		auto           P = covariances.middleRows(begin, count);
+		auto           z = measurements.middleRows(begin, count);
+
+		// y = z - H x, HP = H P
+		Lanes<MeasurementDim, 1>        innovation(count, M);
+		Lanes<MeasurementDim, StateDim> observed(count, M * S);
+		innovation = z;
+		observed.setZero();
+		for (uint32_t m = 0; m < M; ++m)
+			for (uint32_t j = 0; j < S; ++j)
+				if (observation(m, j) != 0)
+				{
+					innovation.col(m) -= observation(m, j) * x.col(j);
+					for (uint32_t c = 0; c < S; ++c)
+						observed.col(at(m, c, M)) +=
+							observation(m, j) * P.col(at(j, c, S));
+				}
+
+		// S = HP H' + R, factored in place into its lower Cholesky factor
+		Lanes<MeasurementDim, MeasurementDim> factor(count, M * M);
+		for (uint32_t m = 0; m < M; ++m)
+			for (uint32_t k = 0; k <= m; ++k)
+			{
+				auto entry = factor.col(at(m, k, M));
+				entry.setConstant(measurementNoise(m, k));
+				for (uint32_t j = 0; j < S; ++j)
+					if (observation(k, j) != 0)
+						entry += observation(k, j) * observed.col(at(m, j, M));
+			}
+
+		Eigen::Array<bool, Eigen::Dynamic, 1, Eigen::ColMajor, LANES, 1>
+			valid = mask.segment(begin, count);
+		for (uint32_t i = 0; i < M; ++i)
+		{
+			for (uint32_t j = 0; j <= i; ++j)
+			{
+				auto entry = factor.col(at(i, j, M));
+				for (uint32_t k = 0; k < j; ++k)
+					entry -= factor.col(at(i, k, M)) * factor.col(at(j, k, M));
+				if (i == j)
+				{
+					valid = valid && entry > 0;
+					entry = entry.max(0).sqrt();
+				}
+				else
+					entry /= factor.col(at(j, j, M));
+			}
+		}
+
+		// K' = S^-1 HP, by forward then back substitution per column of HP
+		Lanes<StateDim, MeasurementDim> gain(count, S * M);
+		for (uint32_t c = 0; c < S; ++c)
+		{
+			for (uint32_t i = 0; i < M; ++i)
+			{
+				auto entry = gain.col(at(c, i, S));
+				entry = observed.col(at(i, c, M));
+				for (uint32_t k = 0; k < i; ++k)
+					entry -= factor.col(at(i, k, M)) * gain.col(at(c, k, S));
+				entry /= factor.col(at(i, i, M));
+			}
+			for (uint32_t i = M; i-- > 0;)
+			{
+				auto entry = gain.col(at(c, i, S));
+				for (uint32_t k = i + 1; k < M; ++k)
+					entry -= factor.col(at(k, i, M)) * gain.col(at(c, k, S));
+				entry /= factor.col(at(i, i, M));
+			}
+		}
+
+		// x += K y
+		Lanes<StateDim, 1> state(count, S);
+		state = x;
+		for (uint32_t c = 0; c < S; ++c)
+			for (uint32_t m = 0; m < M; ++m)
+				state.col(c) += gain.col(at(c, m, S)) * innovation.col(m);
+
+		// Joseph form, P = A P A' + K R K' with A = I - K H
+		Lanes<StateDim, StateDim> correction(count, S * S);
+		for (uint32_t a = 0; a < S; ++a)
+			for (uint32_t b = 0; b < S; ++b)
+			{
+				auto entry = correction.col(at(a, b, S));
+				entry.setConstant(a == b ? 1 : 0);
+				for (uint32_t m = 0; m < M; ++m)
+					if (observation(m, b) != 0)
+						entry -= gain.col(at(a, m, S)) * observation(m, b);
+			}
+
+		Lanes<StateDim, StateDim> product(count, S * S);
+		product.setZero();
+		for (uint32_t a = 0; a < S; ++a)
+			for (uint32_t k = 0; k < S; ++k)
+				for (uint32_t b = 0; b < S; ++b)
+					product.col(at(a, b, S)) += correction.col(at(a, k, S)) *
+						P.col(at(k, b, S));
+
+		Lanes<StateDim, MeasurementDim> noise(count, S * M);
+		noise.setZero();
+		for (uint32_t a = 0; a < S; ++a)
+			for (uint32_t m = 0; m < M; ++m)
+				for (uint32_t n = 0; n < M; ++n)
+					if (measurementNoise(m, n) != 0)
+						noise.col(at(a, n, S)) +=
+							gain.col(at(a, m, S)) * measurementNoise(m, n);
+
+		Lanes<StateDim, StateDim> covariance(count, S * S);
+		for (uint32_t a = 0; a < S; ++a)
+			for (uint32_t b = 0; b < S; ++b)
+			{
+				auto entry = covariance.col(at(a, b, S));
+				entry.setZero();
+				for (uint32_t k = 0; k < S; ++k)
+					entry += product.col(at(a, k, S)) *
+						correction.col(at(b, k, S));
+				for (uint32_t n = 0; n < M; ++n)
+					entry += noise.col(at(a, n, S)) * gain.col(at(b, n, S));
+			}
 
+		for (uint32_t c = 0; c < S; ++c)
+			x.col(c) = valid.select(state.col(c), x.col(c));
+		for (uint32_t c = 0; c < S * S; ++c)
+			P.col(c) = valid.select(covariance.col(c), P.col(c));
+	}
 };
+
+/**
+ * Residual of vectors whose entries at AngleIndices are angles. Those entries
+ * are differenced with angleDifference(), so they wrap into [-pi, pi). A
+ * model used by extendedKalman or unscentedKalman picks this up by deriving
+ * from it.
+ *
+ * @tparam AngleIndices: the entries holding angles in radians
+ */
+template<uint32_t... AngleIndices>
+struct angleResidual
+{
+	template<class Vec>
+	inline Vec residual(const Vec& a, const Vec& b) const
+	{
+		Vec r = a - b;
+		((r(AngleIndices) = angleDifference(a(AngleIndices), b(AngleIndices))),
+			...);
+		return r;
+	}
+};
+
+template<class Model, class Vec, class = void>
+struct hasResidual : std::false_type
+{
+};
+
+template<class Model, class Vec>
+struct hasResidual<Model, Vec, std::void_t<decltype(std::declval<const Model&>()
+	.residual(std::declval<const Vec&>(), std::declval<const Vec&>()))>> :
+	std::true_type
+{
+};
+
+template<class Model, class Vec, class = void>
+struct hasJacobian : std::false_type
+{
+};
+
+template<class Model, class Vec>
+struct hasJacobian<Model, Vec, std::void_t<decltype(std::declval<const Model&>()
+	.jacobian(std::declval<const Vec&>()))>> : std::true_type
+{
+};
+
+/**
+ * Returns a - b through model.residual() when the model has one, plain
+ * subtraction otherwise.
+ */
+template<class Model, class Vec>
+inline Vec modelResidual(const Model& model, const Vec& a, const Vec& b)
+{
+	if constexpr (hasResidual<Model, Vec>::value)
+		return model.residual(a, b);
+	else
+		return a - b;
+}
+
+/**
+ * Returns the Jacobian of model at x through model.jacobian() when the model
+ * has one. Otherwise it is differentiated automatically, by evaluating the
+ * model once on forward-mode dual numbers with a fixed-size derivative, so
+ * nothing allocates. Such a model's operator() must be templated on the
+ * scalar type, and call sin, cos, ... unqualified so Eigen's AutoDiff
+ * overloads are found.
+ *
+ * @tparam Outputs: the size of the model's result
+ */
+template<int Outputs, class Model, class ValueType, int Inputs>
+inline Eigen::Matrix<ValueType, Outputs, Inputs> modelJacobian(
+	const Model& model, const Eigen::Matrix<ValueType, Inputs, 1>& x)
+{
+	if constexpr (hasJacobian<Model, Eigen::Matrix<ValueType, Inputs, 1>>::value)
+		return model.jacobian(x);
+	else
+	{
+		typedef Eigen::AutoDiffScalar<Eigen::Matrix<ValueType, Inputs, 1>> Dual;
+
+		Eigen::Matrix<Dual, Inputs, 1> input;
+		for (int i = 0; i < Inputs; ++i)
+			input(i) = Dual(x(i), Inputs, i);
+		const Eigen::Matrix<Dual, Outputs, 1> output = model(input);
+
+		Eigen::Matrix<ValueType, Outputs, Inputs> jacobian;
+		for (int i = 0; i < Outputs; ++i)
+			jacobian.row(i) = output(i).derivatives().transpose();
+		return jacobian;
+	}
+}
+
+/**
+ * An extended Kalman filter. The process and measurement models are functors
+ * fixed at compile time, so they inline into predict() and update(), and
+ * every matrix is fixed-size, so neither step allocates.
+ *
+ * A model is callable as Vec operator()(const State&), and may provide
+ * Mat jacobian(const State&), otherwise its Jacobian is derived by
+ * modelJacobian(). It may also provide residual(a, b), see angleResidual.
+ *
+ * @tparam StateDim: the number of state variables
+ * @tparam MeasurementDim: the number of measured variables
+ * @tparam ProcessModel: the state transition x = f(x)
+ * @tparam MeasurementModel: the measurement prediction z = h(x)
+ * @tparam ValueType: the scalar type
+ */
+template<uint32_t StateDim, uint32_t MeasurementDim, class ProcessModel,
+	class MeasurementModel, class ValueType = double>
+struct extendedKalman
+{
+public:
+	using my_t           = extendedKalman<StateDim, MeasurementDim,
+		ProcessModel, MeasurementModel, ValueType>;
+	using State          = Eigen::Matrix<ValueType, StateDim, 1>;
+	using Mat            = Eigen::Matrix<ValueType, StateDim, StateDim>;
+	using Measurement    = Eigen::Matrix<ValueType, MeasurementDim, 1>;
+	using MeasurementMat = Eigen::Matrix<ValueType, MeasurementDim, StateDim>;
+	using MeasurementCov =
+		Eigen::Matrix<ValueType, MeasurementDim, MeasurementDim>;
+	using Gain           = Eigen::Matrix<ValueType, StateDim, MeasurementDim>;
+
+public:
+	/**
+	 * The state estimate x, and its covariance P
+	 */
+	State state;
+	Mat   covariance;
+
+	/**
+	 * The process model f, and its noise covariance Q
+	 */
+	ProcessModel processModel;
+	Mat          processNoise;
+
+	/**
+	 * The measurement model h, and its noise covariance R
+	 */
+	MeasurementModel measurementModel;
+	MeasurementCov   measurementNoise;
+
+public:
+	extendedKalman(const ProcessModel& processModel = ProcessModel(),
+		const MeasurementModel& measurementModel = MeasurementModel()) :
+		processModel(processModel), measurementModel(measurementModel)
+	{
+		state.setZero();
+		covariance.setIdentity();
+		processNoise.setZero();
+		measurementNoise.setIdentity();
+	}
+
+	/**
+	 * Propagates the state through the process model.
+	 * x = f(x), P = F P F' + Q with F the Jacobian of f at the prior x
+	 */
+	my_t& predict()
+	{
+		const Mat transition = modelJacobian<StateDim>(processModel, state);
+		state = processModel(state);
+		covariance = transition * covariance * transition.transpose() +
+			processNoise;
+		return *this;
+	}
+
+	/**
+	 * Corrects the state with a measurement, linearising h at the current
+	 * state. The innovation goes through the measurement model's residual,
+	 * and the covariance is updated in Joseph form, see kalman::update().
+	 *
+	 * @param measurement: the measurement z
+	 * @return false, leaving the filter unchanged, if the innovation
+	 *         covariance is not positive definite
+	 */
+	bool update(const Measurement& measurement)
+	{
+		const MeasurementMat observation =
+								 modelJacobian<MeasurementDim>(measurementModel,
+									 state);
+		const Measurement    innovation  = modelResidual(measurementModel,
+			measurement, Measurement(measurementModel(state)));
+		const MeasurementMat observedCovariance = observation * covariance;
+		const MeasurementCov innovationCovariance =
+								 observedCovariance * observation.transpose() +
+								 measurementNoise;
+
+		const Eigen::LLT<MeasurementCov> llt(innovationCovariance);
+		if (llt.info() != Eigen::Success)
+			return false;
+
+		const Gain gain = llt.solve(observedCovariance).transpose();
+		const Mat  correction = Mat::Identity() - gain * observation;
+
+		state += gain * innovation;
+		covariance = correction * covariance * correction.transpose() +
+			gain * measurementNoise * gain.transpose();
+		return true;
+	}
+};
+
+/**
+ * An unscented Kalman filter. Instead of linearising the models it pushes
+ * 2 StateDim + 1 sigma points through them. The sigma points live in
+ * fixed-size matrices and the models are compile-time functors, so predict()
+ * and update() never allocate.
+ *
+ * A model is callable as Vec operator()(const State&), and may provide
+ * residual(a, b), see angleResidual. Means are accumulated as residuals from
+ * the central sigma point, so they stay correct for wrapping quantities.
+ *
+ * @tparam StateDim: the number of state variables
+ * @tparam MeasurementDim: the number of measured variables
+ * @tparam ProcessModel: the state transition x = f(x)
+ * @tparam MeasurementModel: the measurement prediction z = h(x)
+ * @tparam ValueType: the scalar type
+ */
+template<uint32_t StateDim, uint32_t MeasurementDim, class ProcessModel,
+	class MeasurementModel, class ValueType = double>
+struct unscentedKalman
+{
+public:
+	using my_t           = unscentedKalman<StateDim, MeasurementDim,
+		ProcessModel, MeasurementModel, ValueType>;
+	using State          = Eigen::Matrix<ValueType, StateDim, 1>;
+	using Mat            = Eigen::Matrix<ValueType, StateDim, StateDim>;
+	using Measurement    = Eigen::Matrix<ValueType, MeasurementDim, 1>;
+	using MeasurementCov =
+		Eigen::Matrix<ValueType, MeasurementDim, MeasurementDim>;
+	using Gain           = Eigen::Matrix<ValueType, StateDim, MeasurementDim>;
+
+	static constexpr uint32_t SIGMA_POINTS = 2 * StateDim + 1;
+
+	using SigmaPoints    = Eigen::Matrix<ValueType, StateDim, SIGMA_POINTS>;
+	using Weights        = Eigen::Matrix<ValueType, SIGMA_POINTS, 1>;
+
+public:
+	/**
+	 * The state estimate x, and its covariance P
+	 */
+	State state;
+	Mat   covariance;
+
+	/**
+	 * The process model f, and its noise covariance Q
+	 */
+	ProcessModel processModel;
+	Mat          processNoise;
+
+	/**
+	 * The measurement model h, and its noise covariance R
+	 */
+	MeasurementModel measurementModel;
+	MeasurementCov   measurementNoise;
+
+private:
+	ValueType spread;
+	Weights   meanWeights;
+	Weights   covarianceWeights;
+
+public:
+	unscentedKalman(const ProcessModel& processModel = ProcessModel(),
+		const MeasurementModel& measurementModel = MeasurementModel()) :
+		processModel(processModel), measurementModel(measurementModel)
+	{
+		state.setZero();
+		covariance.setIdentity();
+		processNoise.setZero();
+		measurementNoise.setIdentity();
+		setScaling();
+	}
+
+	/**
+	 * Sets the scaled unscented transform parameters.
+	 *
+	 * @param alpha: spread of the sigma points around the mean, in (0, 1]
+	 * @param beta: prior knowledge of the distribution, 2 is optimal for
+	 *        a Gaussian
+	 * @param kappa: secondary scaling, usually 0
+	 */
+	my_t& setScaling(ValueType alpha = 1, ValueType beta = 2,
+		ValueType kappa = 0)
+	{
+		const ValueType n      = StateDim;
+		const ValueType lambda = alpha * alpha * (n + kappa) - n;
+		spread = std::sqrt(n + lambda);
+		meanWeights.setConstant(1 / (2 * (n + lambda)));
+		covarianceWeights = meanWeights;
+		meanWeights(0)       = lambda / (n + lambda);
+		covarianceWeights(0) = meanWeights(0) + 1 - alpha * alpha + beta;
+		return *this;
+	}
+
+	/**
+	 * Propagates the sigma points through the process model.
+	 *
+	 * @return false, leaving the filter unchanged, if the covariance is not
+	 *         positive definite
+	 */
+	bool predict()
+	{
+		SigmaPoints points;
+		if (!sigmaPoints(points))
+			return false;
+		for (uint32_t i = 0; i < SIGMA_POINTS; ++i)
+			points.col(i) = processModel(State(points.col(i)));
+
+		state = mean(processModel, points);
+		covariance = processNoise;
+		for (uint32_t i = 0; i < SIGMA_POINTS; ++i)
+		{
+			const State r = modelResidual(processModel, State(points.col(i)),
+				state);
+			covariance += covarianceWeights(i) * r * r.transpose();
+		}
+		return true;
+	}
+
+	/**
+	 * Corrects the state with a measurement, from the sigma points pushed
+	 * through the measurement model.
+	 *
+	 * @param measurement: the measurement z
+	 * @return false, leaving the filter unchanged, if the covariance or the
+	 *         innovation covariance is not positive definite
+	 */
+	bool update(const Measurement& measurement)
+	{
+		SigmaPoints points;
+		if (!sigmaPoints(points))
+			return false;
+
+		Eigen::Matrix<ValueType, MeasurementDim, SIGMA_POINTS> predicted;
+		for (uint32_t i = 0; i < SIGMA_POINTS; ++i)
+			predicted.col(i) = measurementModel(State(points.col(i)));
+		const Measurement expected = mean(measurementModel, predicted);
+
+		MeasurementCov innovationCovariance = measurementNoise;
+		Gain           crossCovariance;
+		crossCovariance.setZero();
+		for (uint32_t i = 0; i < SIGMA_POINTS; ++i)
+		{
+			const Measurement z = modelResidual(measurementModel,
+				Measurement(predicted.col(i)), expected);
+			const State       x = modelResidual(processModel,
+				State(points.col(i)), state);
+			innovationCovariance += covarianceWeights(i) * z * z.transpose();
+			crossCovariance += covarianceWeights(i) * x * z.transpose();
+		}
+
+		const Eigen::LLT<MeasurementCov> llt(innovationCovariance);
+		if (llt.info() != Eigen::Success)
+			return false;
+
+		// S is symmetric, so K' = S^-1 Pxz'
+		const Gain gain = llt.solve(crossCovariance.transpose()).transpose();
+
+		state += gain * modelResidual(measurementModel, measurement, expected);
+		covariance -= gain * innovationCovariance * gain.transpose();
+		covariance = (covariance + covariance.transpose()) / 2;
+		return true;
+	}
+
+private:
+	/**
+	 * Fills points with x, then x +- spread * each column of the Cholesky
+	 * factor of P.
+	 */
+	bool sigmaPoints(SigmaPoints& points) const
+	{
+		const Eigen::LLT<Mat> llt(covariance);
+		if (llt.info() != Eigen::Success)
+			return false;
+
+		const Mat factor = spread * Mat(llt.matrixL());
+		points.col(0) = state;
+		points.template middleCols<StateDim>(1) = factor.colwise() + state;
+		points.template rightCols<StateDim>() = (-factor).colwise() + state;
+		return true;
+	}
+
+	/**
+	 * The weighted mean of points, as the central point plus the weighted
+	 * residuals of the others from it.
+	 */
+	template<class Model, int Rows>
+	Eigen::Matrix<ValueType, Rows, 1> mean(const Model& model,
+		const Eigen::Matrix<ValueType, Rows, SIGMA_POINTS>& points) const
+	{
+		typedef Eigen::Matrix<ValueType, Rows, 1> Vec;
+
+		const Vec center = points.col(0);
+		Vec       offset = Vec::Zero();
+		for (uint32_t i = 1; i < SIGMA_POINTS; ++i)
+			offset += meanWeights(i) * modelResidual(model, Vec(points.col(i)),
+				center);
+		return center + offset;
+	}
+};
+}
+
+#endif //PROJECTS_KALMAN_HPP
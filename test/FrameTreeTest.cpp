@@ -0,0 +1,63 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/FrameTree.hpp>
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+TEST(FrameTreeTest, 2d_matches_reference_frames)
+{
+	ReferenceFrame2d         world;
+	vector<ReferenceFrame2d> frames(1000);
+	for (size_t i = 0; i < frames.size(); ++i)
+	{
+		Vector3d pose = Vector3d::Random();
+		frames[i] = ReferenceFrame2d(pose(0), pose(1), pose(2),
+			i ? &frames[rand() % i] : &world);
+	}
+
+	vector<const ReferenceFrame2d*> pointers;
+	for (size_t i = frames.size(); i-- > 0;)
+		pointers.push_back(&frames[i]);
+
+	FrameTree2d      tree;
+	vector<uint32_t> indices = tree.add(pointers);
+	ASSERT_EQ(frames.size(), tree.size());
+	for (size_t i = 0; i < tree.size(); ++i)
+		ASSERT_TRUE(tree.getParent(i) == FrameTree2d::NO_PARENT ||
+			tree.getParent(i) < i);
+
+	for (unsigned threads : {1, 4})
+	{
+		world.setYawOffset(threads * .1);
+		tree.setOffset(indices.back(), frames[0].getOffsetFromWorld());
+		tree.update(threads);
+		for (size_t i = 0; i < pointers.size(); ++i)
+			ASSERT_TRUE(tree.getOffsetFromWorld(indices[i])
+				.isApprox(pointers[i]->getOffsetFromWorld(), 1e-12));
+	}
+}
+
+TEST(FrameTreeTest, 3d_rigid_chain)
+{
+	FrameTree<3, double, RigidTransform<3>> tree;
+	RigidTransform<3>::Type                 offset;
+	offset.setIdentity();
+	offset.translation() = Vector3d(1, 0, 0);
+
+	uint32_t frame = tree.add(offset);
+	for (int i = 0; i < 9; ++i)
+		frame = tree.add(offset, frame);
+	tree.update();
+	ASSERT_TRUE(tree.getWorldPosition(frame).isApprox(Vector3d(10, 0, 0)));
+
+	offset.linear() = AngleAxisd(M_PI / 2, Vector3d::UnitZ())
+		.toRotationMatrix();
+	tree.setOffset(0, offset);
+	tree.update(2);
+	ASSERT_TRUE(tree.getWorldPosition(frame).isApprox(Vector3d(1, 9, 0)));
+}
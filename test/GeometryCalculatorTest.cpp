@@ -43,6 +43,47 @@ TEST(GeometryCalculatorTest, 4d_orthogonal)
 	}
 }
 
+TEST(GeometryCalculatorTest, nd_orthogonal)
+{
+	typedef Matrix<double, 6, 1> Vector6d;
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		Vector6d vector           = Vector6d::Random();
+		Vector6d orthogonalVector = orthogonal(vector);
+		ASSERT_NEAR(0, vector.dot(orthogonalVector),
+			numeric_limits<double>::epsilon() * 8);
+		ASSERT_NE(0, orthogonalVector.squaredNorm());
+
+		VectorXd dynamic = vector;
+		ASSERT_EQ(orthogonalVector, orthogonal(dynamic));
+	}
+
+	Vector4d zeroSum(1, -1, 2, -2);
+	ASSERT_EQ(0, zeroSum.dot(orthogonal(zeroSum)));
+	ASSERT_NE(0, orthogonal(zeroSum).squaredNorm());
+}
+
+TEST(GeometryCalculatorTest, orthogonal_expressions)
+{
+	double data[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		Vector3d a = Vector3d::Random();
+		Vector3d b = Vector3d::Random();
+		ASSERT_EQ(orthogonal(Vector3d(a + b)), orthogonal(a + b));
+		ASSERT_EQ(orthogonal(Vector2d(a.head<2>())), orthogonal(a.head<2>()));
+	}
+
+	Map<Vector2d> map2(data);
+	Map<Vector3d> map3(data + 2);
+	Map<Vector4d> map4(data + 5);
+	ASSERT_EQ(orthogonal(Vector2d(1, 2)), orthogonal(map2));
+	ASSERT_EQ(orthogonal(Vector3d(3, 4, 5)), orthogonal(map3));
+	ASSERT_EQ(orthogonal(Vector4d(6, 7, 8, 9)), orthogonal(map4));
+	ASSERT_EQ(1, data[0]);
+	ASSERT_EQ(2, data[1]);
+}
+
 TEST(GeometryCalculatorTest, 2d_Parallel)
 {
 	for (int i = 0; i < TEST_COUNT; ++i)
@@ -0,0 +1,351 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/kalman.hpp>
+#include "gtest/gtest.h"
+
+#define TEST_COUNT 100000
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+typedef kalman<2, 1> ConstantVelocity;
+
+static ConstantVelocity constantVelocity(double dt, double noise)
+{
+	ConstantVelocity filter;
+	filter.transition << 1, dt, 0, 1;
+	filter.processNoise << dt * dt * dt / 3, dt * dt / 2, dt * dt / 2, dt;
+	filter.processNoise *= 1e-6;
+	filter.observation << 1, 0;
+	filter.measurementNoise << noise * noise;
+	filter.covariance *= 100;
+	return filter;
+}
+
+TEST(KalmanTest, constant_velocity)
+{
+	const double     dt     = .001;
+	const double     noise  = .1;
+	ConstantVelocity filter = constantVelocity(dt, noise);
+
+	double position = 3;
+	double velocity = -2;
+	for (int i = 0; i < TEST_COUNT / 10; ++i)
+	{
+		position += velocity * dt;
+		filter.predict();
+		ASSERT_TRUE(filter.update(ConstantVelocity::Measurement(
+			position + noise * Matrix<double, 1, 1>::Random()(0))));
+	}
+
+	ASSERT_NEAR(position, filter.state(0), .01);
+	ASSERT_NEAR(velocity, filter.state(1), .01);
+	ASSERT_TRUE(filter.covariance.isApprox(filter.covariance.transpose()));
+	ASSERT_EQ(Success, filter.covariance.llt().info());
+}
+
+TEST(KalmanTest, matches_textbook_update)
+{
+	kalman<4, 2> filter;
+	filter.state            = Vector4d::Random();
+	filter.covariance       = Matrix4d::Random();
+	filter.covariance       = filter.covariance * filter.covariance.transpose()
+		+ Matrix4d::Identity();
+	filter.observation      = Matrix<double, 2, 4>::Random();
+	filter.measurementNoise = Matrix2d::Identity() * .5;
+
+	Vector4d x = filter.state;
+	Matrix4d P = filter.covariance;
+	Matrix<double, 2, 4> H = filter.observation;
+	Matrix2d R = filter.measurementNoise;
+	Vector2d z = Vector2d::Random();
+
+	Matrix<double, 4, 2> K = P * H.transpose() *
+		(H * P * H.transpose() + R).inverse();
+	Vector4d expectedState      = x + K * (z - H * x);
+	Matrix4d expectedCovariance = (Matrix4d::Identity() - K * H) * P;
+
+	ASSERT_TRUE(filter.update(z));
+	ASSERT_TRUE(filter.state.isApprox(expectedState, 1e-9));
+	ASSERT_TRUE(filter.covariance.isApprox(expectedCovariance, 1e-9));
+}
+
+TEST(KalmanTest, rejects_indefinite_innovation)
+{
+	kalman<2, 1> filter;
+	filter.measurementNoise << -2;
+	Vector2d state = filter.state;
+	ASSERT_FALSE(filter.update(Matrix<double, 1, 1>(1)));
+	ASSERT_EQ(state, filter.state);
+}
+
+TEST(KalmanTest, bank_matches_filters)
+{
+	typedef kalmanBank<4, 2> Bank;
+
+	Bank bank(100);
+	bank.transition       = Matrix4d::Identity();
+	bank.transition.topRightCorner<2, 2>() = Matrix2d::Identity() * .1;
+	bank.processNoise     = Matrix4d::Identity() * .01;
+	bank.observation      = Matrix<double, 2, 4>::Random();
+	bank.measurementNoise << .5, .1, .1, .3;
+
+	vector<Bank::Filter> filters;
+	for (size_t track = 0; track < bank.size(); ++track)
+	{
+		Bank::Filter filter = bank.get(track);
+		filter.state = Vector4d::Random();
+		bank.set(track, filter);
+		filters.push_back(filter);
+	}
+
+	for (unsigned threads : {1, 3})
+		for (int step = 0; step < 10; ++step)
+		{
+			Bank::Measurements measurements =
+				Bank::Measurements::Random(bank.size(), 2);
+			Bank::Mask         mask         =
+				ArrayXd::Random(bank.size()) > 0;
+
+			bank.predict(threads).update(measurements, mask, threads);
+			for (size_t track = 0; track < filters.size(); ++track)
+			{
+				filters[track].predict();
+				if (mask(track))
+					filters[track].update(
+						measurements.row(track).transpose().matrix());
+
+				Bank::Filter filter = bank.get(track);
+				ASSERT_TRUE(filter.state.isApprox(filters[track].state, 1e-9));
+				ASSERT_TRUE(filter.covariance.isApprox(
+					filters[track].covariance, 1e-9));
+			}
+		}
+}
+
+TEST(KalmanTest, bank_skips_indefinite_tracks)
+{
+	kalmanBank<2, 1> bank(3);
+	bank.measurementNoise << -2;
+	bank.states.setOnes();
+	bank.update(kalmanBank<2, 1>::Measurements::Zero(3, 1),
+		kalmanBank<2, 1>::Mask::Constant(3, true));
+	ASSERT_TRUE((bank.states == 1).all());
+}
+
+TEST(KalmanTest, square_root_matches_filter)
+{
+	kalman<4, 2>           filter;
+	squareRootKalman<4, 2, double> squareRoot;
+
+	filter.transition = Matrix4d::Identity();
+	filter.transition.topRightCorner<2, 2>() = Matrix2d::Identity() * .1;
+	filter.processNoise     = Matrix4d::Identity() * .01;
+	filter.observation      = Matrix<double, 2, 4>::Random();
+	filter.measurementNoise << .5, .1, .1, .3;
+	filter.state            = Vector4d::Random();
+
+	squareRoot.transition             = filter.transition;
+	squareRoot.processNoiseFactor     = filter.processNoise.llt().matrixL();
+	squareRoot.observation            = filter.observation;
+	squareRoot.measurementNoiseFactor =
+		filter.measurementNoise.llt().matrixL();
+	squareRoot.state                  = filter.state;
+	ASSERT_TRUE(squareRoot.setCovariance(filter.covariance));
+
+	for (int i = 0; i < 100; ++i)
+	{
+		Vector2d measurement = Vector2d::Random();
+		filter.predict();
+		squareRoot.predict();
+		ASSERT_TRUE(squareRoot.covariance().isApprox(filter.covariance, 1e-9));
+		ASSERT_TRUE(filter.update(measurement));
+		ASSERT_TRUE(squareRoot.update(measurement));
+		ASSERT_TRUE(squareRoot.state.isApprox(filter.state, 1e-9));
+		ASSERT_TRUE(squareRoot.covariance().isApprox(filter.covariance, 1e-9));
+	}
+}
+
+TEST(KalmanTest, square_root_float_stays_positive_definite)
+{
+	const float                     dt = .001f;
+	squareRootKalman<2, 1, float>   filter;
+	filter.transition << 1, dt, 0, 1;
+	filter.processNoiseFactor << 1e-6f, 0, 0, 1e-6f;
+	filter.observation << 1, 0;
+	filter.measurementNoiseFactor << 1e-4f;
+	filter.covarianceFactor *= 1e3f;
+
+	for (int i = 0; i < TEST_COUNT / 10; ++i)
+	{
+		filter.predict();
+		ASSERT_TRUE(filter.update(Matrix<float, 1, 1>(i * dt * dt)));
+	}
+
+	ASSERT_TRUE((filter.covarianceFactor.diagonal().array() > 0).all());
+	ASSERT_EQ(Success, filter.covariance().llt().info());
+	ASSERT_NEAR(dt, filter.state(1), 1e-4);
+}
+
+struct Unicycle : public angleResidual<2>
+{
+	double speed = 1, turnRate = .5, dt = .1;
+
+	template<class Vec>
+	Vec operator()(const Vec& x) const
+	{
+		using std::cos;
+		using std::sin;
+		Vec next = x;
+		next(0) += speed * dt * cos(x(2));
+		next(1) += speed * dt * sin(x(2));
+		next(2) += turnRate * dt;
+		return next;
+	}
+};
+
+struct UnicycleJacobian : public Unicycle
+{
+	Matrix3d jacobian(const Vector3d& x) const
+	{
+		Matrix3d j = Matrix3d::Identity();
+		j(0, 2) = -speed * dt * std::sin(x(2));
+		j(1, 2) = speed * dt * std::cos(x(2));
+		return j;
+	}
+};
+
+struct RangeBearing : public angleResidual<1, 3>
+{
+	Vector2d landmarks[2] = {Vector2d(2, 1), Vector2d(-1, 2)};
+
+	template<class Vec>
+	Matrix<typename Vec::Scalar, 4, 1> operator()(const Vec& x) const
+	{
+		using std::atan2;
+		using std::sqrt;
+		Matrix<typename Vec::Scalar, 4, 1> z;
+		for (int i = 0; i < 2; ++i)
+		{
+			typename Vec::Scalar dx = landmarks[i](0) - x(0);
+			typename Vec::Scalar dy = landmarks[i](1) - x(1);
+			z(2 * i) = sqrt(dx * dx + dy * dy);
+			z(2 * i + 1) = atan2(dy, dx) - x(2);
+		}
+		return z;
+	}
+};
+
+template<class Filter>
+static void trackUnicycle(Filter& filter)
+{
+	Unicycle     truthModel;
+	RangeBearing sensor;
+	Vector3d     truth(0, 0, 3);
+
+	filter.state << .2, -.2, 2.8;
+	filter.covariance = Vector3d(.1, .1, .1).asDiagonal();
+	filter.processNoise = Vector3d(1e-6, 1e-6, 1e-6).asDiagonal();
+	filter.measurementNoise = Vector4d::Constant(1e-4).asDiagonal();
+	for (int i = 0; i < 200; ++i)
+	{
+		truth = truthModel(truth);
+		filter.predict();
+		ASSERT_TRUE(filter.update(sensor(truth)));
+	}
+
+	ASSERT_NEAR(truth(0), filter.state(0), 1e-2);
+	ASSERT_NEAR(truth(1), filter.state(1), 1e-2);
+	ASSERT_NEAR(0, angleDifference(truth(2), filter.state(2)), 1e-2);
+}
+
+TEST(KalmanTest, automatic_jacobian_matches_analytic)
+{
+	UnicycleJacobian model;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		Vector3d x = Vector3d::Random() * 4;
+		ASSERT_TRUE(modelJacobian<3>(static_cast<const Unicycle&>(model), x)
+			.isApprox(model.jacobian(x), 1e-12));
+	}
+
+	RangeBearing sensor;
+	Vector3d     x(.5, -.5, .3);
+	Matrix<double, 4, 3> numeric;
+	for (int i = 0; i < 3; ++i)
+	{
+		Vector3d h = Vector3d::Unit(i) * 1e-6;
+		numeric.col(i) = (sensor(Vector3d(x + h)) - sensor(Vector3d(x - h))) /
+			2e-6;
+	}
+	ASSERT_TRUE(modelJacobian<4>(sensor, x).isApprox(numeric, 1e-6));
+}
+
+TEST(KalmanTest, angle_residual_wraps)
+{
+	RangeBearing sensor;
+	Vector4d     r = sensor.residual(Vector4d(1, 3.1, 1, -3),
+		Vector4d(.5, -3.1, 1, 3));
+	ASSERT_NEAR(.5, r(0), 1e-12);
+	ASSERT_NEAR(6.2 - 2 * M_PI, r(1), 1e-12);
+	ASSERT_NEAR(0, r(2), 1e-12);
+	ASSERT_NEAR(2 * M_PI - 6, r(3), 1e-12);
+}
+
+TEST(KalmanTest, extended_tracks_unicycle)
+{
+	extendedKalman<3, 4, Unicycle, RangeBearing> automatic;
+	trackUnicycle(automatic);
+
+	extendedKalman<3, 4, UnicycleJacobian, RangeBearing> analytic;
+	trackUnicycle(analytic);
+}
+
+TEST(KalmanTest, unscented_tracks_unicycle)
+{
+	unscentedKalman<3, 4, Unicycle, RangeBearing> filter;
+	trackUnicycle(filter);
+}
+
+struct LinearModel
+{
+	Matrix2d transition;
+
+	Vector2d operator()(const Vector2d& x) const
+	{
+		return transition * x;
+	}
+};
+
+struct PositionModel
+{
+	Matrix<double, 1, 1> operator()(const Vector2d& x) const
+	{
+		return x.head<1>();
+	}
+};
+
+TEST(KalmanTest, unscented_matches_filter_for_linear_models)
+{
+	ConstantVelocity filter = constantVelocity(.1, .5);
+	unscentedKalman<2, 1, LinearModel, PositionModel> unscented;
+	unscented.processModel.transition = filter.transition;
+	unscented.processNoise = filter.processNoise;
+	unscented.measurementNoise = filter.measurementNoise;
+	unscented.covariance = filter.covariance;
+	unscented.setScaling(.5, 2, 1);
+
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		filter.predict();
+		ASSERT_TRUE(unscented.predict());
+		Matrix<double, 1, 1> z(sin(i * .01));
+		ASSERT_TRUE(filter.update(z));
+		ASSERT_TRUE(unscented.update(z));
+		ASSERT_LT((unscented.state - filter.state).norm(), 1e-9);
+		ASSERT_LT((unscented.covariance - filter.covariance).norm(), 1e-9);
+	}
+}
@@ -100,3 +100,39 @@ TEST(MathTest, zeroTo2Pi)
 		for (int i = -10; i <= 10; ++i)
 			ASSERT_NEAR(a, zeroTo2Pi(a + two_pi<double>() * i), 1e-9);
 }
+
+TEST(MathTest, angleDifference_array)
+{
+	Eigen::ArrayXd a = Eigen::ArrayXd::Random(TEST_COUNT) * 20;
+	Eigen::ArrayXd b = Eigen::ArrayXd::Random(TEST_COUNT) * 20;
+	a.head<4>() << pi<double>(), two_pi<double>(), 0, -pi<double>();
+	b.head<4>() << 0, 0, pi<double>(), 0;
+
+	Eigen::ArrayXd r = angleDifference(a, b);
+	for (int i = 0; i < TEST_COUNT; ++i)
+		ASSERT_EQ(angleDifference(a(i), b(i)), r(i));
+
+	angleDifference(a.data(), b.data(), a.data(), TEST_COUNT);
+	ASSERT_TRUE((a == r).all());
+}
+
+TEST(MathTest, zeroTo2Pi_array)
+{
+	Eigen::ArrayXf a = Eigen::ArrayXf::Random(TEST_COUNT) * 20;
+	Eigen::ArrayXf r = zeroTo2Pi(a);
+	Eigen::ArrayXf m = unsignedMod(a, 3.f);
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		ASSERT_EQ(zeroTo2Pi(a(i)), r(i));
+		ASSERT_EQ(unsignedMod(a(i), 3.f), m(i));
+	}
+}
+
+TEST(MathTest, intervalDifference_array)
+{
+	Eigen::ArrayXd a = Eigen::ArrayXd::Random(TEST_COUNT) * 20;
+	Eigen::ArrayXd b = Eigen::ArrayXd::Random(TEST_COUNT) * 20;
+	Eigen::ArrayXd r = intervalDifference(a, b, -1., 2.);
+	for (int i = 0; i < TEST_COUNT; ++i)
+		ASSERT_EQ(intervalDifference(a(i), b(i), -1., 2.), r(i));
+}
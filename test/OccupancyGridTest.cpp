@@ -0,0 +1,231 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/OccupancyGrid.hpp>
+#include <map>
+#include <set>
+#include "gtest/gtest.h"
+
+#define TEST_COUNT 200
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * Maps every index() of grid back to its cell.
+ */
+template<uint32_t DIM>
+static map<size_t, typename OccupancyGrid<DIM>::Cell> cells(
+	const OccupancyGrid<DIM>& grid)
+{
+	typedef typename OccupancyGrid<DIM>::Cell Cell;
+
+	map<size_t, Cell> cells;
+	const Cell&       size = grid.getSize();
+	Cell              cell = Cell::Zero();
+	while (cell[DIM - 1] < size[DIM - 1])
+	{
+		cells[grid.index(cell)] = cell;
+		for (uint32_t i = 0; i < DIM && ++cell[i] == size[i] && i + 1 < DIM;
+			++i)
+			cell[i] = 0;
+	}
+	return cells;
+}
+
+/**
+ * Casts random rays from inside and outside grid, and checks the cells
+ * traverse() visits are face neighbours in order, with contiguous distances,
+ * and include every cell found by sampling the ray finely.
+ */
+template<uint32_t DIM>
+static void matchesSampling(const OccupancyGrid<DIM>& grid)
+{
+	typedef typename OccupancyGrid<DIM>::Vec  Vec;
+	typedef typename OccupancyGrid<DIM>::Cell Cell;
+
+	const auto      lookup = cells(grid);
+	const double    side   = grid.getSize().maxCoeff() * grid.getResolution();
+	srand(1);
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		const Ray<DIM> ray(Vec::Random() * side, Vec::Random().normalized());
+		const double   length = (Vec::Random()[0] + 1) * side;
+
+		vector<Cell> visited;
+		double       last = -1;
+		grid.traverse(ray, length, [&](size_t index, double enter, double exit)
+		{
+			ASSERT_EQ(1u, lookup.count(index));
+			ASSERT_LE(enter, exit);
+			if (last >= 0)
+				ASSERT_NEAR(last, enter, 1e-9);
+			last = exit;
+			visited.push_back(lookup.at(index));
+		});
+		ASSERT_LE(last, length + 1e-9);
+
+		for (size_t j = 1; j < visited.size(); ++j)
+			ASSERT_EQ(1, (visited[j] - visited[j - 1]).cwiseAbs().sum());
+		set<size_t> unique;
+		for (const Cell& cell : visited)
+			ASSERT_TRUE(unique.insert(grid.index(cell)).second);
+
+		const size_t STEPS = 2000;
+		for (size_t j = 0; j <= STEPS; ++j)
+		{
+			const double t = length * j / STEPS;
+			Cell         cell;
+			if (!grid.cell(ray.start + ray.normalizedDirection * t, cell))
+				continue;
+			// Skip samples too close to a cell boundary to tell
+			const Vec offset = (ray.start + ray.normalizedDirection * t) /
+				grid.getResolution();
+			if (((offset.array() - offset.array().round()).abs() < 1e-6).any())
+				continue;
+			ASSERT_NE(visited.end(), find(visited.begin(), visited.end(), cell))
+				<< "ray " << i << " sample " << j;
+		}
+	}
+}
+
+TEST(OccupancyGridTest, index)
+{
+	OccupancyGrid2d grid(Vector2d::Zero(), OccupancyGrid2d::Cell(13, 21),
+		.5);
+	const auto lookup = cells(grid);
+	ASSERT_EQ(13u * 21u, lookup.size());
+	for (const auto& entry : lookup)
+		ASSERT_LT(entry.first, size_t(16 * 24));
+
+	// Cells of one tile are contiguous
+	ASSERT_EQ(grid.index(OccupancyGrid2d::Cell(0, 0)) + 1,
+		grid.index(OccupancyGrid2d::Cell(1, 0)));
+	ASSERT_EQ(grid.index(OccupancyGrid2d::Cell(0, 0)) + 8,
+		grid.index(OccupancyGrid2d::Cell(0, 1)));
+	ASSERT_EQ(grid.index(OccupancyGrid2d::Cell(0, 0)) + 64,
+		grid.index(OccupancyGrid2d::Cell(8, 0)));
+
+	OccupancyGrid2d::Cell cell;
+	ASSERT_TRUE(grid.cell(Vector2d(6.2, 10.4), cell));
+	ASSERT_EQ(OccupancyGrid2d::Cell(12, 20), cell);
+	ASSERT_FALSE(grid.cell(Vector2d(6.6, 1), cell));
+	ASSERT_FALSE(grid.cell(Vector2d(1, -.1), cell));
+}
+
+TEST(OccupancyGridTest, axis_aligned)
+{
+	OccupancyGrid2d grid(Vector2d(-1, -1), OccupancyGrid2d::Cell(20, 20), .1);
+
+	vector<size_t> indices;
+	vector<double> enters;
+	ASSERT_EQ(6u, grid.traverse(Ray2d(Vector2d(-1.5, -.95), Vector2d(1, 0)),
+		1.05, [&](size_t index, double enter, double)
+		{
+			indices.push_back(index);
+			enters.push_back(enter);
+		}));
+	for (int64_t x = 0; x < 6; ++x)
+	{
+		ASSERT_EQ(grid.index(OccupancyGrid2d::Cell(x, 0)), indices[x]);
+		ASSERT_NEAR(.5 + x * .1, enters[x], 1e-12);
+	}
+
+	// Backwards along y from inside
+	indices.clear();
+	ASSERT_EQ(3u, grid.traverse(Ray2d(Vector2d(.05, .25), Vector2d(0, -1)),
+		.2, [&](size_t index, double, double)
+		{
+			indices.push_back(index);
+		}));
+	ASSERT_EQ(grid.index(OccupancyGrid2d::Cell(10, 12)), indices[0]);
+	ASSERT_EQ(grid.index(OccupancyGrid2d::Cell(10, 10)), indices[2]);
+
+	// Missing the grid
+	ASSERT_EQ(0u, grid.traverse(Ray2d(Vector2d(-2, 2), Vector2d(1, 0)), 10,
+		[](size_t, double, double) {}));
+	ASSERT_EQ(0u, grid.traverse(Ray2d(Vector2d(-2, 0), Vector2d(1, 0)), .5,
+		[](size_t, double, double) {}));
+}
+
+TEST(OccupancyGridTest, matches_sampling_2d)
+{
+	matchesSampling(OccupancyGrid2d(Vector2d(-3, -2),
+		OccupancyGrid2d::Cell(37, 25), .2));
+}
+
+TEST(OccupancyGridTest, matches_sampling_3d)
+{
+	matchesSampling(OccupancyGrid3d(Vector3d(-1, -2, -1.5),
+		OccupancyGrid3d::Cell(11, 19, 14), .2));
+}
+
+TEST(OccupancyGridTest, integrate)
+{
+	OccupancyGrid2d grid(Vector2d::Zero(), OccupancyGrid2d::Cell(10, 10), 1);
+	grid.setLogOdds(1, -.5, -1, 2);
+
+	const Ray2d ray(Vector2d(.5, 3.5), Vector2d(1, 0));
+	grid.integrate(ray, 4, 8);
+	for (int64_t x = 0; x < 4; ++x)
+		ASSERT_FLOAT_EQ(-.5, grid.logOdds(OccupancyGrid2d::Cell(x, 3)));
+	ASSERT_FLOAT_EQ(1, grid.logOdds(OccupancyGrid2d::Cell(4, 3)));
+	ASSERT_FLOAT_EQ(0, grid.logOdds(OccupancyGrid2d::Cell(5, 3)));
+	ASSERT_NEAR(1 / (1 + exp(-1.)), grid.probability(
+		OccupancyGrid2d::Cell(4, 3)), 1e-6);
+
+	// Clamped
+	grid.integrate(ray, 4, 8);
+	grid.integrate(ray, 4, 8);
+	ASSERT_FLOAT_EQ(-1, grid.logOdds(OccupancyGrid2d::Cell(0, 3)));
+	ASSERT_FLOAT_EQ(2, grid.logOdds(OccupancyGrid2d::Cell(4, 3)));
+
+	// Nothing hit within maxRange, every cell is free
+	grid.clear();
+	grid.integrate(ray, 8, 6);
+	for (int64_t x = 0; x < 7; ++x)
+		ASSERT_FLOAT_EQ(-.5, grid.logOdds(OccupancyGrid2d::Cell(x, 3)));
+	ASSERT_FLOAT_EQ(0, grid.logOdds(OccupancyGrid2d::Cell(7, 3)));
+}
+
+TEST(OccupancyGridTest, parallel_matches_sequential)
+{
+	OccupancyGrid2d sequential(Vector2d(-8, -8), OccupancyGrid2d::Cell(161,
+		161), .1);
+	sequential.setLogOdds(.85, -.4, -1e3, 1e3);
+	OccupancyGrid2d parallel(sequential);
+
+	srand(1);
+	vector<Ray2d>  rays;
+	vector<double> ranges;
+	for (int scan = 0; scan < 4; ++scan)
+	{
+		const Vector2d origin = Vector2d::Random() * 2;
+		for (int beam = 0; beam < 360; ++beam)
+		{
+			const double angle = beam * M_PI / 180;
+			rays.emplace_back(origin, Vector2d(cos(angle), sin(angle)));
+			ranges.push_back(beam % 7 ? 2 + (Vector2d::Random()[0] + 1) * 2 :
+				10);
+		}
+	}
+
+	for (size_t i = 0; i < rays.size(); ++i)
+		sequential.integrate(rays[i], ranges[i], 8);
+	parallel.integrate(rays, ranges, 8, 3);
+	// The scratch tiles are reused
+	parallel.integrate(rays, ranges, 8, 4);
+	for (size_t i = 0; i < rays.size(); ++i)
+		sequential.integrate(rays[i], ranges[i], 8);
+
+	// Sums are in a different order, so only equal to float precision
+	const auto lookup = cells(sequential);
+	for (const auto& entry : lookup)
+	{
+		const float expected = sequential.logOdds(entry.second);
+		ASSERT_NEAR(expected, parallel.logOdds(entry.second),
+			1e-5 * max(1.f, abs(expected)));
+	}
+}
@@ -0,0 +1,153 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/RayPacket.hpp>
+#include <math/geometry/SegmentBVH.hpp>
+#include <math/geometry/SpatialTree.h>
+#include "gtest/gtest.h"
+
+#define TEST_COUNT 1000
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * WIDTH rays fanning out from one origin, like neighbouring beams of a scan.
+ */
+template<uint32_t DIM, class ValueType, int WIDTH>
+static vector<Ray<DIM, ValueType>> fan(ValueType spread)
+{
+	typedef Matrix<ValueType, DIM, 1> Vec;
+
+	const Vec                   start     = Vec::Random() * 10;
+	const Vec                   direction = Vec::Random().normalized();
+	vector<Ray<DIM, ValueType>> rays;
+	for (int lane = 0; lane < WIDTH; ++lane)
+		rays.emplace_back(start, (direction + Vec::Random() * spread)
+			.normalized());
+	return rays;
+}
+
+static vector<LineSegment2d> randomWalls(size_t count)
+{
+	vector<LineSegment2d> segments;
+	for (size_t i = 0; i < count; ++i)
+	{
+		Vector2d start = Vector2d::Random() * 10;
+		segments.emplace_back(start, start + Vector2d::Random());
+	}
+	return segments;
+}
+
+TEST(RayPacketTest, segment_distance)
+{
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		vector<Ray2d> rays = fan<2, double, 4>(1.);
+		RayPacket2d   packet(rays.data(), rays.size());
+		LineSegment2d segment(Vector2d::Random() * 10,
+			Vector2d::Random() * 10);
+
+		RayPacket2d::Lanes distances;
+		RayPacket2d::Mask  hit = packet.distance(segment, distances);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			double distance;
+			ASSERT_EQ(rays[lane].distance(segment, distance) == INTERSECT,
+				hit(lane));
+			if (hit(lane))
+				ASSERT_NEAR(distance, distances(lane), 1e-9);
+		}
+	}
+}
+
+TEST(RayPacketTest, partial_packet)
+{
+	vector<Ray2d> rays = fan<2, double, 4>(.1);
+	RayPacket2d   packet(rays.data(), 3);
+	ASSERT_TRUE(packet.active.head(3).all());
+	ASSERT_FALSE(packet.active(3));
+	ASSERT_EQ(rays[2].start, packet.ray(2).start);
+	ASSERT_EQ(rays[2].normalizedDirection, packet.ray(2).normalizedDirection);
+	ASSERT_EQ(0, RayPacket2d::first(packet.active));
+	ASSERT_EQ(-1, RayPacket2d::first(RayPacket2d::Mask::Constant(false)));
+}
+
+template<class Packet>
+static void expectBVHMatchesSingle(const SegmentBVH2d& bvh,
+	const vector<Ray2d>& rays)
+{
+	Packet                   packet(rays.data(), rays.size());
+	typename Packet::Indices ids;
+	typename Packet::Lanes   distances;
+	bvh.raycast(packet, ids, distances);
+	for (size_t lane = 0; lane < rays.size(); ++lane)
+	{
+		uint32_t id;
+		double   distance;
+		if (bvh.raycast(rays[lane], id, distance))
+			ASSERT_NEAR(distance, distances(lane), 1e-9);
+		else
+			ASSERT_EQ(0xFFFFFFFF, ids(lane));
+	}
+}
+
+TEST(RayPacketTest, bvh_coherent)
+{
+	SegmentBVH2d bvh(randomWalls(1000));
+	for (int i = 0; i < TEST_COUNT; ++i)
+		expectBVHMatchesSingle<RayPacket2d>(bvh, fan<2, double, 4>(.05));
+}
+
+TEST(RayPacketTest, bvh_divergent)
+{
+	SegmentBVH2d bvh(randomWalls(1000));
+	for (int i = 0; i < TEST_COUNT; ++i)
+		expectBVHMatchesSingle<RayPacket2d>(bvh, fan<2, double, 4>(2.));
+}
+
+TEST(RayPacketTest, bvh_8_wide)
+{
+	typedef RayPacket<2, double, 8> Packet8;
+
+	SegmentBVH2d bvh(randomWalls(1000));
+	for (int i = 0; i < TEST_COUNT; ++i)
+		expectBVHMatchesSingle<Packet8>(bvh, fan<2, double, 8>(.05));
+}
+
+TEST(RayPacketTest, spatial_tree)
+{
+	typedef SpatialTree<3, Vector3d> Tree;
+
+	Tree tree(Vector3d::Constant(-10), 20);
+	for (int i = 0; i < 10000; ++i)
+		tree.insert(Vector3d::Random() * 9.99);
+
+	const double radius = .2;
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		vector<Ray3d> rays = fan<3, double, 4>(i % 2 ? .05 : 2.);
+		RayPacket3d   packet(rays.data(), rays.size());
+
+		const Vector3d*     elements[4];
+		RayPacket3d::Lanes distances;
+		RayPacket3d::Mask  hit = tree.raycast(packet, radius, elements,
+			distances);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			const Vector3d* element;
+			double          distance;
+			ASSERT_EQ(tree.raycast(rays[lane], radius, element, distance),
+				hit(lane));
+			if (hit(lane))
+			{
+				ASSERT_NEAR(distance, distances(lane), 1e-9);
+				ASSERT_NE(nullptr, elements[lane]);
+			}
+			else
+				ASSERT_EQ(nullptr, elements[lane]);
+		}
+	}
+}
@@ -0,0 +1,185 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/Ray.hpp>
+#include "gtest/gtest.h"
+
+#define TEST_COUNT 100000
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+static LineSegment2d randomRaySegment(const Ray2d& ray, int kind)
+{
+	Vector2d intersectionPoint = ray.start + ray.normalizedDirection *
+		(Vector2d::Random()(0) + 1.5) * (kind & 4 ? -1 : 1);
+	Vector2d position2         = Vector2d::Random();
+	Vector2d position3         =
+				 (intersectionPoint - position2) * (kind & 1 ? .99 : 1.01);
+	if (kind & 2)
+		position2 += position3;
+	return LineSegment2d(position2, position2 + position3);
+}
+
+TEST(RayTest, 2d_Ray_Seg)
+{
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		Ray2d         ray(Vector2d::Random(), Vector2d::Random().normalized());
+		LineSegment2d segment = randomRaySegment(ray, i % 8);
+
+		double           dist;
+		IntersectionType type = ray.distance(segment, dist);
+		// Only the unshifted long segment, and the shifted short one, reach
+		// the ray ahead of its start
+		ASSERT_EQ(i % 8 == 0 || i % 8 == 3 ? INTERSECT : NONE, type);
+		if (i % 8 == 0)
+			ASSERT_NEAR((segment.start + segment.extends / 1.01 - ray.start)
+				.norm(), dist, 1e-9);
+	}
+}
+
+TEST(RayTest, 2d_d2_Closed_Form)
+{
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		Vector2d p1 = Vector2d::Random();
+		Vector2d v1 = Vector2d::Random().normalized();
+		Vector2d p2 = Vector2d::Random();
+		Vector2d v2 = Vector2d::Random();
+		Vector2d result;
+		double   d1, d2;
+		ASSERT_EQ(INTERSECT,
+			intersectionDistance(p1, v1, p2, v2, result, d1, d2));
+		ASSERT_LE((p2 + v2 * d2 - result).norm(),
+			1e-9 * max(1., result.norm()));
+	}
+
+	Vector2d result;
+	double   d1, d2;
+	ASSERT_EQ(NONE, intersectionDistance(Vector2d(0, 0), Vector2d(1, 0),
+		Vector2d(0, 1), Vector2d(1, 0), result, d1, d2));
+	ASSERT_EQ(numeric_limits<double>::infinity(), d1);
+	ASSERT_EQ(numeric_limits<double>::infinity(), d2);
+	ASSERT_EQ(COINCIDENT, intersectionDistance(Vector2d(0, 0), Vector2d(1, 0),
+		Vector2d(2, 0), Vector2d(1, 0), result, d1, d2));
+	ASSERT_EQ(0, d1);
+	ASSERT_EQ(0, d2);
+}
+
+TEST(RayTest, 3d_Ray_Seg)
+{
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		Ray3d    ray(Vector3d::Random(), Vector3d::Random().normalized());
+		double   expected = Vector3d::Random()(0) + 1.5;
+		Vector3d point    = ray.start + ray.normalizedDirection * expected *
+			(i & 4 ? -1 : 1);
+		Vector3d start    = Vector3d::Random();
+		Vector3d extends  = (point - start) * (i & 1 ? .99 : 1.01);
+		if (i & 2)
+			start += extends;
+
+		double           dist;
+		IntersectionType type = ray.distance(LineSegment3d(start,
+			start + extends), dist);
+		ASSERT_EQ(i % 8 == 0 || i % 8 == 3 ? INTERSECT : NONE, type);
+		if (type == INTERSECT)
+			ASSERT_NEAR(expected, dist, 1e-9);
+	}
+}
+
+TEST(RayTest, 2d_Batch_Matches_Scalar)
+{
+	Ray2d ray(Vector2d::Random(), Vector2d::Random().normalized());
+
+	vector<LineSegment2d> segments;
+	for (int i = 0; i < TEST_COUNT; ++i)
+		segments.push_back(randomRaySegment(ray, i % 8));
+
+	LineSegmentBlock2d block(segments);
+	Ray2d::Distances   distances(block.size());
+	Ray2d::Types       types(block.size());
+	ray.distance(block, distances, types);
+
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		double           expected;
+		IntersectionType type = ray.distance(segments[i], expected);
+		ASSERT_EQ(type, types(i));
+		if (type == INTERSECT)
+			ASSERT_NEAR(expected, distances(i), 1e-9);
+		else
+			ASSERT_EQ(numeric_limits<double>::infinity(), distances(i));
+	}
+}
+
+TEST(RayTest, 2d_Batch_Parallel)
+{
+	Ray2d              ray(Vector2d(0, 0), Vector2d(1, 0));
+	LineSegmentBlock2d block(vector<LineSegment2d>{
+		LineSegment2d(Vector2d(1, 1), Vector2d(2, 1)),
+		LineSegment2d(Vector2d(1, 0), Vector2d(2, 0)),
+		LineSegment2d(Vector2d(1, -1), Vector2d(1, 1))});
+	Ray2d::Distances   distances(block.size());
+	Ray2d::Types       types(block.size());
+	ray.distance(block, distances, types);
+
+	ASSERT_EQ(NONE, types(0));
+	ASSERT_EQ(COINCIDENT, types(1));
+	ASSERT_EQ(0, distances(1));
+	ASSERT_EQ(INTERSECT, types(2));
+	ASSERT_NEAR(1, distances(2), 1e-12);
+}
+
+TEST(RayTest, 2d_Batch_Many_Rays)
+{
+	vector<Ray2d>         rays;
+	vector<LineSegment2d> segments;
+	for (int i = 0; i < 16; ++i)
+		rays.push_back(Ray2d(Vector2d::Random(),
+			Vector2d::Random().normalized()));
+	for (int i = 0; i < 64; ++i)
+		segments.push_back(randomRaySegment(rays[i % 16], i % 8));
+
+	LineSegmentBlock2d  block(segments);
+	ArrayXXd            distances(block.size(), rays.size());
+	ArrayXXi            types(block.size(), rays.size());
+	distance(rays, block, distances, types);
+
+	for (size_t j = 0; j < rays.size(); ++j)
+		for (size_t i = 0; i < segments.size(); ++i)
+		{
+			double           expected;
+			IntersectionType type = rays[j].distance(segments[i], expected);
+			ASSERT_EQ(type, types(i, j));
+			if (type == INTERSECT)
+				ASSERT_NEAR(expected, distances(i, j), 1e-9);
+		}
+}
+
+TEST(RayTest, 3d_Batch_Hit)
+{
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		Vector3d intersectionPoint = Vector3d::Random();
+		Vector3d position1         = Vector3d::Random();
+		Ray3d    ray(position1, (intersectionPoint - position1).normalized());
+		Vector3d position2         = Vector3d::Random();
+		Vector3d position3         = (intersectionPoint - position2) * 1.01;
+
+		LineSegmentBlock3d block(vector<LineSegment3d>{
+			LineSegment3d(position2, position2 + position3),
+			LineSegment3d(position2, position2 + position3 * .98)});
+		Ray3d::Distances   distances(block.size());
+		Ray3d::Types       types(block.size());
+		ray.distance(block, distances, types);
+
+		ASSERT_EQ(INTERSECT, types(0));
+		ASSERT_NEAR((intersectionPoint - position1).norm(), distances(0),
+			1e-9);
+		ASSERT_EQ(NONE, types(1));
+	}
+}
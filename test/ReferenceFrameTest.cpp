@@ -23,3 +23,122 @@ TEST(ReferenceFrameTest, 2d_unit_circle)
 		ASSERT_NEAR(i, t, numeric_limits<double>::epsilon());
 	}
 }
+
+TEST(ReferenceFrameTest, 2d_chain_cache)
+{
+	ReferenceFrame<2>         world;
+	vector<ReferenceFrame<2>> chain(16);
+	for (size_t i = 0; i < chain.size(); ++i)
+		chain[i] = ReferenceFrame<2>(1, 0, 0, i ? &chain[i - 1] : &world);
+
+	double x, y, t;
+	chain.back().getXYYaw(x, y, t);
+	ASSERT_NEAR(16, x, 1e-12);
+	ASSERT_NEAR(0, y, 1e-12);
+
+	world.setYawOffset(M_PI / 2);
+	chain.back().getXYYaw(x, y, t);
+	ASSERT_NEAR(0, x, 1e-12);
+	ASSERT_NEAR(16, y, 1e-12);
+	ASSERT_NEAR(M_PI / 2, t, 1e-12);
+
+	chain[7].transformationMatrix(1, 2) = 1;
+	chain[7].invalidate();
+	ASSERT_NEAR(-1, chain.back().getWorldPosition()(0), 1e-12);
+	ASSERT_NEAR(16, chain.back().getWorldPosition()(1), 1e-12);
+
+	chain[8].setParent(&world);
+	ASSERT_NEAR(8, chain.back().getWorldPosition()(1), 1e-12);
+}
+
+TEST(ReferenceFrameTest, 3d_world_position)
+{
+	ReferenceFrame<3> world;
+	ReferenceFrame<3> point(&world);
+	point.setXOffset(1).setYOffset(2).setZOffset(3);
+	world.setZOffset(-3);
+	ASSERT_EQ(Vector3d(1, 2, 0), point.getWorldPosition());
+	ASSERT_EQ(Vector3d(1, 2, 3), point.getTranslationOffset());
+}
+
+TEST(ReferenceFrameTest, 2d_rigid_matches_homogeneous)
+{
+	ReferenceFrame2d      world;
+	ReferenceFrame2d      arm(.5, .25, .1, &world);
+	ReferenceFrame2d      point(1, 0, -.3, &arm);
+	RigidReferenceFrame2d rigidWorld;
+	RigidReferenceFrame2d rigidArm(.5, .25, .1, &rigidWorld);
+	RigidReferenceFrame2d rigidPoint(1, 0, -.3, &rigidArm);
+	ASSERT_LT(sizeof(rigidPoint.transformationMatrix),
+		sizeof(point.transformationMatrix));
+
+	for (double i = -M_PI; i < M_PI; i += .01)
+	{
+		world.setYawOffset(i).setXOffset(i);
+		rigidWorld.setYawOffset(i).setXOffset(i);
+		double x, y, t, rx, ry, rt;
+		point.getXYYaw(x, y, t);
+		rigidPoint.getXYYaw(rx, ry, rt);
+		ASSERT_NEAR(x, rx, 1e-12);
+		ASSERT_NEAR(y, ry, 1e-12);
+		ASSERT_NEAR(t, rt, 1e-12);
+
+		ASSERT_TRUE((point.getOffsetFromWorld() * point.getOffsetToWorld())
+			.isIdentity(1e-12));
+		ASSERT_TRUE((rigidPoint.getOffsetFromWorld() *
+			rigidPoint.getOffsetToWorld()).matrix().isIdentity(1e-12));
+	}
+}
+
+TEST(ReferenceFrameTest, 3d_rigid_world_position)
+{
+	RigidReferenceFrame3d world;
+	RigidReferenceFrame3d point(&world);
+	point.setXOffset(1).setYOffset(2).setZOffset(3);
+	world.setZOffset(-3);
+	ASSERT_EQ(Vector3d(1, 2, 0), point.getWorldPosition());
+	ASSERT_TRUE(point.getOffsetToWorld().translation()
+		.isApprox(Vector3d(-1, -2, 0)));
+}
+
+TEST(ReferenceFrameTest, 2d_transform_points)
+{
+	ReferenceFrame2d world;
+	ReferenceFrame2d robot(1, 2, .3, &world);
+	ReferenceFrame2d sensor(.5, 0, -.1, &robot);
+	ReferenceFrame2d landmark(-3, 4, 1, &world);
+
+	Matrix2Xd in  = Matrix2Xd::Random(2, 1000);
+	Matrix2Xd out(2, in.cols());
+	for (unsigned threads : {1, 3})
+	{
+		transformPoints(sensor, landmark, in, out, threads);
+
+		Matrix3d offset = landmark.getOffsetToWorld() *
+			sensor.getOffsetFromWorld();
+		for (Index i = 0; i < in.cols(); ++i)
+			ASSERT_TRUE(out.col(i).isApprox((offset *
+				in.col(i).homogeneous()).head<2>(), 1e-12));
+	}
+
+	vector<Vector2d> points(10, Vector2d(1, 0));
+	vector<Vector2d> moved(points.size());
+	transformPoints(sensor, sensor, points.data(), moved.data(),
+		points.size());
+	for (const Vector2d& point : moved)
+		ASSERT_TRUE(point.isApprox(Vector2d(1, 0), 1e-12));
+}
+
+TEST(ReferenceFrameTest, 3d_rigid_transform_points)
+{
+	RigidReferenceFrame3d world;
+	RigidReferenceFrame3d from(&world);
+	RigidReferenceFrame3d to(&world);
+	from.setXOffset(1);
+	to.setZOffset(1);
+
+	Matrix3Xd in  = Matrix3Xd::Random(3, 100);
+	Matrix3Xd out(3, in.cols());
+	transformPoints(from, to, in, out);
+	ASSERT_TRUE(out.isApprox(in.colwise() + Vector3d(1, 0, -1), 1e-12));
+}
@@ -0,0 +1,129 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/ReferenceFrame.hpp>
+#include <math/geometry/ScanSimulator.hpp>
+#include "gtest/gtest.h"
+
+#define TEST_COUNT 100
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * The walls of the box [-1, 1]^2
+ */
+static vector<LineSegment2d> room()
+{
+	return {LineSegment2d(Vector2d(-1, -1), Vector2d(1, -1)),
+		LineSegment2d(Vector2d(1, -1), Vector2d(1, 1)),
+		LineSegment2d(Vector2d(1, 1), Vector2d(-1, 1)),
+		LineSegment2d(Vector2d(-1, 1), Vector2d(-1, -1))};
+}
+
+TEST(ScanSimulatorTest, room)
+{
+	ScanSimulator2d simulator(2);
+	simulator.setMap(room());
+	simulator.setBeams(4, 0, 3 * M_PI / 2, 10);
+	ASSERT_EQ(4u, simulator.beams());
+
+	ReferenceFrame2d         pose(.5, 0, M_PI / 2);
+	ScanSimulator2d::Ranges ranges(4);
+	ASSERT_TRUE(simulator.scan(pose, ranges));
+	// Beams point +y, -x, -y and +x in the world
+	ASSERT_NEAR(1, ranges(0), 1e-12);
+	ASSERT_NEAR(1.5, ranges(1), 1e-12);
+	ASSERT_NEAR(1, ranges(2), 1e-12);
+	ASSERT_NEAR(.5, ranges(3), 1e-12);
+
+	ScanSimulator2d::Ranges wrong(3);
+	ASSERT_FALSE(simulator.scan(pose, wrong));
+}
+
+TEST(ScanSimulatorTest, max_range)
+{
+	ScanSimulator2d simulator(1);
+	simulator.setMap({LineSegment2d(Vector2d(2, -1), Vector2d(2, 1))});
+	simulator.setBeams(3, -M_PI / 2, M_PI / 2, 5);
+
+	ReferenceFrame2d         pose;
+	ScanSimulator2d::Ranges ranges(3);
+	ASSERT_TRUE(simulator.scan(pose, ranges));
+	ASSERT_EQ(5, ranges(0));
+	ASSERT_NEAR(2, ranges(1), 1e-12);
+	ASSERT_EQ(5, ranges(2));
+
+	simulator.setBeams(3, -M_PI / 2, M_PI / 2, 1);
+	ASSERT_TRUE(simulator.scan(pose, ranges));
+	ASSERT_EQ(1, ranges(1));
+}
+
+TEST(ScanSimulatorTest, matches_single_rays)
+{
+	vector<LineSegment2d> segments;
+	for (int i = 0; i < 500; ++i)
+	{
+		Vector2d start = Vector2d::Random() * 10;
+		segments.emplace_back(start, start + Vector2d::Random());
+	}
+
+	ScanSimulator2d simulator(4, 3);
+	simulator.setMap(segments);
+	simulator.setBeams(361, -M_PI, M_PI, 8);
+
+	ReferenceFrame2d                world;
+	vector<ReferenceFrame2d>        frames;
+	vector<const ReferenceFrame2d*> poses;
+	for (int i = 0; i < 8; ++i)
+	{
+		frames.emplace_back(Vector2d::Random()(0) * 8,
+			Vector2d::Random()(0) * 8, Vector2d::Random()(0) * M_PI);
+		frames.back().setParent(&world);
+	}
+	for (const ReferenceFrame2d& frame : frames)
+		poses.push_back(&frame);
+	world.setXOffset(.5);
+
+	ScanSimulator2d::RangeMatrix ranges(simulator.beams(), poses.size());
+	ASSERT_TRUE(simulator.scan(poses.data(), poses.size(), ranges));
+
+	const ArrayXd angles = ArrayXd::LinSpaced(361, -M_PI, M_PI);
+	for (size_t j = 0; j < poses.size(); ++j)
+	{
+		double x, y, yaw;
+		poses[j]->getXYYaw(x, y, yaw);
+		for (Index i = 0; i < angles.size(); ++i)
+		{
+			Ray2d  ray(Vector2d(x, y), Vector2d(cos(yaw + angles(i)),
+				sin(yaw + angles(i))));
+			double expected = 8;
+			for (const LineSegment2d& segment : segments)
+			{
+				double distance;
+				if (ray.distance(segment, distance) == INTERSECT)
+					expected = min(expected, distance);
+			}
+			ASSERT_NEAR(expected, ranges(i, j), 1e-9);
+		}
+	}
+}
+
+TEST(ScanSimulatorTest, worker_pool)
+{
+	WorkerPool          pool(4);
+	vector<atomic<int>> counts(1000);
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		pool.run(counts.size(), 7, [&](size_t begin, size_t end, unsigned)
+		{
+			for (size_t k = begin; k < end; ++k)
+				++counts[k];
+		});
+	}
+	for (const atomic<int>& count : counts)
+		ASSERT_EQ(TEST_COUNT, count.load());
+	ASSERT_EQ(4u, pool.size());
+}
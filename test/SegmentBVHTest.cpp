@@ -0,0 +1,184 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/SegmentBVH.hpp>
+#include "gtest/gtest.h"
+
+#define TEST_COUNT 1000
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+/**
+ * The nearest hit of a linear scan over every segment.
+ */
+template<uint32_t DIM>
+static bool linearRaycast(const Ray<DIM>& ray,
+	const vector<LineSegment<DIM>>& segments, double& distance)
+{
+	distance = numeric_limits<double>::infinity();
+	for (const LineSegment<DIM>& segment : segments)
+	{
+		double hit;
+		if (ray.distance(segment, hit) == INTERSECT && hit < distance)
+			distance = hit;
+	}
+	return distance != numeric_limits<double>::infinity();
+}
+
+template<uint32_t DIM>
+static void expectSameAsLinear(const SegmentBVH<DIM>& bvh,
+	const vector<LineSegment<DIM>>& segments, const Ray<DIM>& ray)
+{
+	double   expected, distance;
+	uint32_t id;
+	bool     hit = linearRaycast(ray, segments, expected);
+	ASSERT_EQ(hit, bvh.raycast(ray, id, distance));
+	if (hit)
+	{
+		ASSERT_EQ(expected, distance);
+		ASSERT_EQ(INTERSECT, ray.distance(segments[id], distance));
+		ASSERT_EQ(expected, distance);
+	}
+}
+
+static vector<LineSegment2d> randomWalls(size_t count)
+{
+	vector<LineSegment2d> segments;
+	for (size_t i = 0; i < count; ++i)
+	{
+		Vector2d start = Vector2d::Random() * 10;
+		Vector2d end   = start + Vector2d::Random();
+		// Every third wall is axis aligned, which gives a flat box
+		if (i % 3 == 0)
+			end(i % 2) = start(i % 2);
+		segments.emplace_back(start, end);
+	}
+	return segments;
+}
+
+TEST(SegmentBVHTest, 2d_raycast)
+{
+	vector<LineSegment2d> segments = randomWalls(1000);
+	SegmentBVH2d          bvh(segments);
+	ASSERT_EQ(segments.size(), bvh.size());
+	for (int i = 0; i < TEST_COUNT; ++i)
+		expectSameAsLinear(bvh,
+			segments, Ray2d(Vector2d::Random() * 12,
+				Vector2d::Random().normalized()));
+}
+
+TEST(SegmentBVHTest, 2d_axis_aligned_rays)
+{
+	vector<LineSegment2d> segments = randomWalls(500);
+	SegmentBVH2d          bvh(segments, 1);
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		Vector2d direction = Vector2d::Zero();
+		direction(i % 2) = i % 4 < 2 ? 1 : -1;
+		expectSameAsLinear(bvh, segments,
+			Ray2d(Vector2d::Random() * 12, direction));
+	}
+}
+
+TEST(SegmentBVHTest, 3d_raycast)
+{
+	vector<LineSegment3d> segments;
+	for (int i = 0; i < 500; ++i)
+	{
+		// Segments in the plane z = 0, so rays in it can hit them
+		Vector3d start = Vector3d::Random() * 10;
+		start(2) = 0;
+		Vector3d extends = Vector3d::Random();
+		extends(2) = 0;
+		segments.emplace_back(start, start + extends);
+	}
+
+	SegmentBVH3d bvh(segments);
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		Vector3d start     = Vector3d::Random() * 12;
+		Vector3d direction = Vector3d::Random();
+		start(2)     = 0;
+		direction(2) = 0;
+		expectSameAsLinear(bvh, segments, Ray3d(start,
+			direction.normalized()));
+	}
+}
+
+TEST(SegmentBVHTest, update)
+{
+	vector<LineSegment2d> segments = randomWalls(1000);
+	SegmentBVH2d          bvh(segments);
+	for (int frame = 0; frame < 20; ++frame)
+	{
+		for (uint32_t i = frame; i < segments.size(); i += 7)
+		{
+			Vector2d offset = Vector2d::Random();
+			segments[i].start += offset;
+			bvh.update(i, segments[i]);
+			ASSERT_EQ(segments[i].start, bvh.segment(i).start);
+		}
+		for (int i = 0; i < TEST_COUNT / 20; ++i)
+			expectSameAsLinear(bvh, segments, Ray2d(Vector2d::Random() * 12,
+				Vector2d::Random().normalized()));
+	}
+}
+
+TEST(SegmentBVHTest, refit)
+{
+	vector<LineSegment2d> segments = randomWalls(1000);
+	SegmentBVH2d          moved(segments);
+	for (LineSegment2d& segment : segments)
+		segment.start *= 1.5;
+	for (uint32_t i = 0; i < segments.size(); ++i)
+		moved.set(i, segments[i]);
+	moved.refit();
+
+	for (int i = 0; i < TEST_COUNT; ++i)
+		expectSameAsLinear(moved, segments, Ray2d(Vector2d::Random() * 16,
+			Vector2d::Random().normalized()));
+}
+
+TEST(SegmentBVHTest, batch)
+{
+	vector<LineSegment2d> segments = randomWalls(1000);
+	SegmentBVH2d          bvh(segments);
+	vector<Ray2d>         rays;
+	for (int i = 0; i < TEST_COUNT; ++i)
+		rays.emplace_back(Vector2d::Random() * 12,
+			Vector2d::Random().normalized());
+
+	vector<uint32_t> ids;
+	vector<double>   distances;
+	bvh.raycast(rays, ids, distances, 4);
+	ASSERT_EQ(rays.size(), ids.size());
+	for (size_t i = 0; i < rays.size(); ++i)
+	{
+		double expected;
+		if (linearRaycast(rays[i], segments, expected))
+			ASSERT_EQ(expected, distances[i]);
+		else
+		{
+			ASSERT_EQ(0xFFFFFFFF, ids[i]);
+			ASSERT_EQ(numeric_limits<double>::infinity(), distances[i]);
+		}
+	}
+}
+
+TEST(SegmentBVHTest, empty)
+{
+	SegmentBVH2d bvh;
+	uint32_t     id;
+	double       distance;
+	ASSERT_TRUE(bvh.empty());
+	ASSERT_FALSE(bvh.raycast(Ray2d(Vector2d::Zero(), Vector2d(1, 0)), id,
+		distance));
+	bvh.build({LineSegment2d(Vector2d(1, -1), Vector2d(1, 1))});
+	ASSERT_TRUE(bvh.raycast(Ray2d(Vector2d::Zero(), Vector2d(1, 0)), id,
+		distance));
+	ASSERT_EQ(0u, id);
+	ASSERT_DOUBLE_EQ(1, distance);
+}
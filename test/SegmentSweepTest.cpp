@@ -0,0 +1,123 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/SegmentSweep.hpp>
+#include "gtest/gtest.h"
+
+#define TEST_COUNT 100
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+static void expectSameAsBruteForce(const vector<LineSegment2d>& segments)
+{
+	vector<SegmentPair> expected, pairs;
+	intersectionsBruteForce(segments, expected);
+	intersections(segments, pairs);
+	ASSERT_EQ(expected.size(), pairs.size());
+	for (size_t i = 0; i < pairs.size(); ++i)
+	{
+		ASSERT_EQ(expected[i].first, pairs[i].first);
+		ASSERT_EQ(expected[i].second, pairs[i].second);
+		ASSERT_EQ(expected[i].type, pairs[i].type);
+	}
+}
+
+TEST(SegmentSweepTest, segment_intersection)
+{
+	LineSegment2d a(Vector2d(0, 0), Vector2d(2, 0));
+	ASSERT_EQ(INTERSECT,
+		segmentIntersection(a, LineSegment2d(Vector2d(1, -1), Vector2d(1, 1))));
+	ASSERT_EQ(INTERSECT,
+		segmentIntersection(a, LineSegment2d(Vector2d(1, 0), Vector2d(1, 1))));
+	ASSERT_EQ(INTERSECT,
+		segmentIntersection(a, LineSegment2d(Vector2d(2, 0), Vector2d(3, 1))));
+	ASSERT_EQ(NONE,
+		segmentIntersection(a, LineSegment2d(Vector2d(3, -1), Vector2d(3, 1))));
+	ASSERT_EQ(COINCIDENT,
+		segmentIntersection(a, LineSegment2d(Vector2d(3, 0), Vector2d(1, 0))));
+	ASSERT_EQ(COINCIDENT,
+		segmentIntersection(a, LineSegment2d(Vector2d(2, 0), Vector2d(3, 0))));
+	ASSERT_EQ(NONE,
+		segmentIntersection(a, LineSegment2d(Vector2d(3, 0), Vector2d(4, 0))));
+	ASSERT_EQ(NONE,
+		segmentIntersection(a, LineSegment2d(Vector2d(0, 1), Vector2d(2, 1))));
+	ASSERT_EQ(NONE,
+		segmentIntersection(a, LineSegment2d(Vector2d(1, 1), Vector2d(1, 1))));
+}
+
+TEST(SegmentSweepTest, random_segments)
+{
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		vector<LineSegment2d> segments;
+		for (int j = 0; j < 200; ++j)
+		{
+			Vector2d start = Vector2d::Random() * 10;
+			segments.emplace_back(start, start + Vector2d::Random() *
+				(j % 4 ? 1 : 5));
+		}
+		expectSameAsBruteForce(segments);
+	}
+}
+
+TEST(SegmentSweepTest, axis_aligned_grid)
+{
+	// Walls on a grid share endpoints, cross, overlap and are vertical
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		vector<LineSegment2d> segments;
+		for (int j = 0; j < 100; ++j)
+		{
+			Vector2d start   = (Vector2d::Random() * 5).array().round();
+			Vector2d extends = Vector2d::Zero();
+			extends(j % 2)   = round(Vector2d::Random()(0) * 4);
+			if (extends(j % 2) == 0)
+				extends(j % 2) = 1;
+			segments.emplace_back(start, start + extends);
+		}
+		expectSameAsBruteForce(segments);
+	}
+}
+
+TEST(SegmentSweepTest, shared_points)
+{
+	// A star of segments meeting in one point, all pairs touch there
+	vector<LineSegment2d> segments;
+	for (int i = 0; i < 12; ++i)
+	{
+		double angle = i * M_PI / 6 + .1;
+		segments.emplace_back(Vector2d(1, 1),
+			Vector2d(1 + cos(angle), 1 + sin(angle)));
+	}
+	// A polyline through it, each link touching the next
+	for (int i = 0; i < 6; ++i)
+		segments.emplace_back(Vector2d(i - 2, (i % 2) * 2 - 1),
+			Vector2d(i - 1, ((i + 1) % 2) * 2 - 1));
+
+	vector<SegmentPair> pairs;
+	intersections(segments, pairs);
+	size_t star = 0;
+	for (const SegmentPair& pair : pairs)
+		star += pair.second < 12;
+	ASSERT_EQ(12u * 11 / 2, star);
+	expectSameAsBruteForce(segments);
+}
+
+TEST(SegmentSweepTest, reuse)
+{
+	SegmentSweep<double>  sweep;
+	vector<SegmentPair>   pairs, expected;
+	vector<LineSegment2d> segments;
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		segments.clear();
+		for (int j = 0; j < 50; ++j)
+			segments.emplace_back(Vector2d::Random(), Vector2d::Random());
+		ASSERT_EQ(intersectionsBruteForce(segments, expected),
+			sweep.find(segments, pairs));
+		ASSERT_TRUE(expected == pairs);
+	}
+}
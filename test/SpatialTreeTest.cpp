@@ -0,0 +1,446 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/geometry/SpatialTree.h>
+#include "gtest/gtest.h"
+
+#define TEST_COUNT 100000
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+typedef SpatialTree<2, Vector2d> Tree2d;
+typedef SpatialTree<3, Vector3d> Tree3d;
+
+TEST(SpatialTreeTest, 2d_bounds)
+{
+	Tree2d tree(Vector2d(-1, -1), 2);
+	ASSERT_TRUE(tree.bounds(Vector2d(-1, -1)));
+	ASSERT_TRUE(tree.bounds(Vector2d(0, .99)));
+	ASSERT_FALSE(tree.bounds(Vector2d(1, 0)));
+	ASSERT_FALSE(tree.bounds(Vector2d(0, -1.01)));
+}
+
+TEST(SpatialTreeTest, 2d_insert)
+{
+	Tree2d tree(Vector2d(-1, -1), 2);
+	ASSERT_TRUE(tree.empty());
+	for (int i = 0; i < TEST_COUNT; ++i)
+		ASSERT_TRUE(tree.insert(Vector2d::Random() * .999));
+	ASSERT_EQ(TEST_COUNT, tree.count());
+	ASSERT_FALSE(tree.insert(Vector2d(2, 0)));
+	ASSERT_EQ(TEST_COUNT, tree.count());
+}
+
+TEST(SpatialTreeTest, 3d_insert_clear)
+{
+	Tree3d tree(Vector3d::Zero(), Vector3d(-1, -1, -1), 2);
+	ASSERT_EQ(1, tree.count());
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		tree.clear();
+		ASSERT_TRUE(tree.empty());
+		for (int i = 0; i < TEST_COUNT / 10; ++i)
+			ASSERT_TRUE(tree.insert(Vector3d::Random() * .999));
+		ASSERT_EQ(TEST_COUNT / 10, tree.count());
+	}
+}
+
+TEST(SpatialTreeTest, 2d_raycast)
+{
+	Tree2d           tree(Vector2d(-1, -1), 2);
+	vector<Vector2d> points;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		points.push_back(Vector2d::Random() * .999);
+		tree.insert(points.back());
+	}
+
+	const double radius = .01;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		Ray2d ray(Vector2d::Random(), Vector2d::Random().normalized());
+
+		double expected = numeric_limits<double>::infinity();
+		for (const Vector2d& point : points)
+		{
+			double t = (point - ray.start).dot(ray.normalizedDirection);
+			if (t >= 0 && (point - ray.start - ray.normalizedDirection * t)
+				.norm() <= radius)
+				expected = min(expected, t);
+		}
+
+		const Vector2d* element;
+		double          dist;
+		bool            hit = tree.raycast(ray, radius, element, dist);
+		ASSERT_EQ(expected != numeric_limits<double>::infinity(), hit);
+		if (hit)
+		{
+			ASSERT_EQ(expected, dist);
+			ASSERT_NEAR(expected,
+				(*element - ray.start).dot(ray.normalizedDirection), 1e-12);
+		}
+	}
+}
+
+TEST(SpatialTreeTest, 2d_raycast_segments)
+{
+	struct Wall : public Vector2d
+	{
+		LineSegment2d segment;
+
+		Wall(const LineSegment2d& segment) :
+			Vector2d(segment.start + segment.extends / 2), segment(segment)
+		{
+		}
+	};
+
+	SpatialTree<2, Wall> tree(Vector2d(-1, -1), 2);
+	Wall                 near(LineSegment2d(Vector2d(.5, -.1),
+		Vector2d(.5, .1)));
+	Wall                 far(LineSegment2d(Vector2d(.7, -.1),
+		Vector2d(.7, .1)));
+	tree.insert(far);
+	tree.insert(near);
+
+	const Wall* element;
+	double      dist;
+	ASSERT_TRUE(tree.raycast(Ray2d(Vector2d(0, 0), Vector2d(1, 0)), .1,
+		[](const Wall& wall, const Ray2d& ray, double& distance)
+		{
+			return ray.distance(wall.segment, distance) == INTERSECT;
+		}, element, dist));
+	ASSERT_NEAR(.5, dist, 1e-12);
+	ASSERT_EQ(near.segment.start, element->segment.start);
+}
+
+TEST(SpatialTreeTest, 3d_knn)
+{
+	Tree3d           tree(Vector3d(-1, -1, -1), 2);
+	vector<Vector3d> points;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		points.push_back(Vector3d::Random() * .999);
+		tree.insert(points.back());
+	}
+
+	vector<Tree3d::Neighbour> neighbours;
+	vector<double>            expected;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		Vector3d point = Vector3d::Random() * 1.5;
+
+		expected.clear();
+		for (const Vector3d& p : points)
+			expected.push_back((p - point).squaredNorm());
+		sort(expected.begin(), expected.end());
+
+		ASSERT_EQ(8, tree.knn(point, 8, neighbours));
+		for (int j = 0; j < 8; ++j)
+		{
+			ASSERT_EQ(expected[j], neighbours[j].distanceSquared);
+			ASSERT_EQ(expected[j],
+				(*neighbours[j].element - point).squaredNorm());
+		}
+	}
+
+	ASSERT_EQ(points.size(), tree.knn(Vector3d::Zero(), points.size() * 2,
+		neighbours));
+}
+
+TEST(SpatialTreeTest, 2d_radius)
+{
+	Tree2d           tree(Vector2d(-1, -1), 2);
+	vector<Vector2d> points;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		points.push_back(Vector2d::Random() * .999);
+		tree.insert(points.back());
+	}
+
+	vector<Tree2d::Neighbour> neighbours;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		Vector2d point = Vector2d::Random();
+		double   r     = (Vector2d::Random()(0) + 1) * .1;
+
+		size_t expected = 0;
+		for (const Vector2d& p : points)
+			if ((p - point).squaredNorm() <= r * r)
+				++expected;
+
+		ASSERT_EQ(expected, tree.radius(point, r, neighbours));
+		for (const Tree2d::Neighbour& neighbour : neighbours)
+			ASSERT_LE(neighbour.distanceSquared, r * r);
+	}
+}
+
+TEST(SpatialTreeTest, 2d_build)
+{
+	vector<Vector2d> points;
+	for (int i = 0; i < TEST_COUNT; ++i)
+		points.push_back(Vector2d::Random() * .999);
+	points.push_back(Vector2d(2, 0));
+
+	for (unsigned threads : {1, 4})
+	{
+		Tree2d built(Vector2d(-1, -1), 2);
+		ASSERT_EQ(TEST_COUNT, built.build(points, threads));
+		ASSERT_EQ(TEST_COUNT, built.count());
+
+		vector<Tree2d::Neighbour> neighbours;
+		for (int i = 0; i < TEST_COUNT; i += 100)
+		{
+			ASSERT_EQ(1, built.knn(points[i], 1, neighbours));
+			ASSERT_EQ(0, neighbours[0].distanceSquared);
+		}
+	}
+}
+
+TEST(SpatialTreeTest, 3d_build_matches_insert)
+{
+	vector<Vector3d> points;
+	for (int i = 0; i < TEST_COUNT / 10; ++i)
+		points.push_back(Vector3d::Random() * .999);
+	points.push_back(points.front());
+
+	Tree3d built(Vector3d(-1, -1, -1), 2);
+	Tree3d inserted(Vector3d(-1, -1, -1), 2);
+	built.build(points, 3);
+	for (const Vector3d& point : points)
+		inserted.insert(point);
+	ASSERT_EQ(inserted.count(), built.count());
+
+	vector<Tree3d::Neighbour> expected;
+	vector<Tree3d::Neighbour> actual;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		Vector3d point = Vector3d::Random();
+		ASSERT_EQ(inserted.radius(point, .2, expected),
+			built.radius(point, .2, actual));
+		ASSERT_EQ(5, inserted.knn(point, 5, expected));
+		ASSERT_EQ(5, built.knn(point, 5, actual));
+		for (int j = 0; j < 5; ++j)
+			ASSERT_EQ(expected[j].distanceSquared, actual[j].distanceSquared);
+	}
+}
+
+/**
+ * Checks radius() of tree against brute force over the live points.
+ */
+template<class Tree, class Vec>
+static void expectRadius(const Tree& tree, const vector<Vec>& points,
+	const vector<bool>& live)
+{
+	vector<typename Tree::Neighbour> neighbours;
+	for (int i = 0; i < TEST_COUNT / 1000; ++i)
+	{
+		Vec    point = Vec::Random();
+		double r     = (Vec::Random()(0) + 1) * .2;
+
+		size_t expected = 0;
+		for (size_t j = 0; j < points.size(); ++j)
+			if (live[j] && (points[j] - point).squaredNorm() <= r * r)
+				++expected;
+		ASSERT_EQ(expected, tree.radius(point, r, neighbours));
+	}
+}
+
+TEST(SpatialTreeTest, 2d_remove)
+{
+	Tree2d                 tree(Vector2d(-1, -1), 2);
+	vector<Vector2d>       points;
+	vector<Tree2d::Handle> handles;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+	{
+		points.push_back(Vector2d::Random() * .999);
+		handles.emplace_back();
+		ASSERT_TRUE(tree.insert(points.back(), handles.back()));
+	}
+
+	vector<bool> live(points.size(), true);
+	for (size_t i = 0; i < points.size(); i += 2)
+	{
+		ASSERT_TRUE(tree.remove(handles[i]));
+		ASSERT_FALSE(tree.remove(handles[i]));
+		ASSERT_EQ(nullptr, tree.element(handles[i]));
+		live[i] = false;
+	}
+	ASSERT_EQ(points.size() / 2, tree.count());
+	for (size_t i = 1; i < points.size(); i += 2)
+		ASSERT_EQ(points[i], *tree.element(handles[i]));
+	expectRadius(tree, points, live);
+
+	// Freed handles and nodes are reused
+	Tree2d::Handle handle;
+	ASSERT_TRUE(tree.insert(Vector2d(.5, .5), handle));
+	ASSERT_EQ(handles[points.size() - 2], handle);
+	ASSERT_TRUE(tree.remove(handle));
+
+	for (size_t i = 1; i < points.size(); i += 2)
+		ASSERT_TRUE(tree.remove(handles[i]));
+	ASSERT_TRUE(tree.empty());
+	ASSERT_EQ(0, tree.count());
+	ASSERT_TRUE(tree.insert(Vector2d(.5, .5)));
+	ASSERT_EQ(1, tree.count());
+}
+
+TEST(SpatialTreeTest, 3d_move)
+{
+	vector<Vector3d> points;
+	for (int i = 0; i < TEST_COUNT / 100; ++i)
+		points.push_back(Vector3d::Random() * .999);
+	const vector<bool> live(points.size(), true);
+
+	Tree3d tree(Vector3d(-1, -1, -1), 2);
+	ASSERT_EQ(points.size(), tree.build(points, 2));
+	for (size_t i = 0; i < points.size(); ++i)
+		ASSERT_EQ(points[i], *tree.element(i));
+
+	for (int frame = 0; frame < 10; ++frame)
+	{
+		for (size_t i = frame % 3; i < points.size(); i += 3)
+		{
+			// Mostly small steps, some jumps across the tree
+			const Vector3d next = i % 10 ? (points[i] + Vector3d::Random() *
+				.02).cwiseMax(-.999).cwiseMin(.999) : Vector3d(
+				Vector3d::Random() * .999);
+			ASSERT_TRUE(tree.move(i, next));
+			points[i] = next;
+		}
+		ASSERT_EQ(points.size(), tree.count());
+		for (size_t i = 0; i < points.size(); ++i)
+			ASSERT_EQ(points[i], *tree.element(i));
+		expectRadius(tree, points, live);
+	}
+
+	ASSERT_FALSE(tree.move(0, Vector3d(2, 0, 0)));
+	ASSERT_EQ(points[0], *tree.element(0));
+	ASSERT_FALSE(tree.move(points.size(), Vector3d::Zero()));
+
+	vector<Tree3d::Neighbour> neighbours;
+	ASSERT_EQ(1, tree.knn(points[7], 1, neighbours));
+	ASSERT_EQ(0, neighbours[0].distanceSquared);
+}
+
+TEST(SpatialTreeTest, 3d_max_depth)
+{
+	Tree3d tree(Vector3d(-1, -1, -1), 2, 4);
+	ASSERT_EQ(4u, tree.getMaxDepth());
+
+	// Repeated points chain buckets at the maximum depth instead of splitting
+	const Vector3d         repeated(.3, -.2, .1);
+	vector<Tree3d::Handle> handles(TEST_COUNT / 100);
+	for (Tree3d::Handle& handle : handles)
+		ASSERT_TRUE(tree.insert(repeated, handle));
+	ASSERT_EQ(5u, tree.nodeCount());
+
+	vector<Tree3d::Neighbour> neighbours;
+	ASSERT_EQ(handles.size(), tree.radius(repeated, 0, neighbours));
+	ASSERT_EQ(handles.size(), tree.knn(repeated, handles.size() * 2,
+		neighbours));
+
+	const Ray3d     ray(Vector3d(-1, -.2, .1), Vector3d(1, 0, 0));
+	const Vector3d* element;
+	double          distance;
+	ASSERT_TRUE(tree.raycast(ray, .01, element, distance));
+	ASSERT_NEAR(1.3, distance, 1e-12);
+
+	for (size_t i = 0; i < handles.size(); i += 2)
+		ASSERT_TRUE(tree.remove(handles[i]));
+	ASSERT_EQ(handles.size() / 2, tree.radius(repeated, 0, neighbours));
+
+	Tree3d built(Vector3d(-1, -1, -1), 2, 4);
+	ASSERT_EQ(handles.size(), built.build(vector<Vector3d>(handles.size(),
+		repeated), 3));
+	ASSERT_EQ(5u, built.nodeCount());
+	ASSERT_EQ(handles.size(), built.radius(repeated, 0, neighbours));
+}
+
+TEST(SpatialTreeTest, 2d_collapse)
+{
+	Tree2d                 tree(Vector2d(-1, -1), 2);
+	vector<Tree2d::Handle> handles(TEST_COUNT / 100);
+	for (Tree2d::Handle& handle : handles)
+		ASSERT_TRUE(tree.insert(Vector2d::Random() * .999, handle));
+	ASSERT_LT(1u, tree.nodeCount());
+
+	// Half a bucket or less collapses back into the root
+	for (size_t i = 4; i < handles.size(); ++i)
+		ASSERT_TRUE(tree.remove(handles[i]));
+	ASSERT_EQ(4u, tree.count());
+	ASSERT_EQ(1u, tree.nodeCount());
+
+	vector<Tree2d::Neighbour> neighbours;
+	ASSERT_EQ(4u, tree.knn(Vector2d::Zero(), 10, neighbours));
+	for (size_t i = 0; i < 4; ++i)
+		ASSERT_NE(nullptr, tree.element(handles[i]));
+}
+
+/**
+ * Random insertions, removals and moves in a tree with buckets of BUCKET,
+ * checked against brute force.
+ */
+template<uint32_t BUCKET>
+static void randomEdits()
+{
+	typedef SpatialTree<2, Vector2d, double, BUCKET> Tree;
+
+	Tree                          tree(Vector2d(-1, -1), 2);
+	vector<Vector2d>              points;
+	vector<typename Tree::Handle> handles;
+	vector<bool>                  live;
+	for (int i = 0; i < TEST_COUNT / 20; ++i)
+	{
+		const int    edit = rand() % 4;
+		const size_t j    = points.empty() ? 0 : rand() % points.size();
+		if (edit < 2 || points.empty())
+		{
+			points.push_back(Vector2d::Random() * .999);
+			handles.emplace_back();
+			live.push_back(true);
+			ASSERT_TRUE(tree.insert(points.back(), handles.back()));
+		}
+		else if (edit == 2 && live[j])
+		{
+			ASSERT_TRUE(tree.remove(handles[j]));
+			live[j] = false;
+		}
+		else if (live[j])
+		{
+			points[j] = (points[j] + Vector2d::Random() * .05).cwiseMax(-.999)
+				.cwiseMin(.999);
+			ASSERT_TRUE(tree.move(handles[j], points[j]));
+		}
+	}
+	ASSERT_EQ(size_t(count(live.begin(), live.end(), true)), tree.count());
+	for (size_t j = 0; j < points.size(); ++j)
+		if (live[j])
+			ASSERT_EQ(points[j], *tree.element(handles[j]));
+	expectRadius(tree, points, live);
+
+	vector<typename Tree::Neighbour> neighbours;
+	for (int i = 0; i < TEST_COUNT / 1000; ++i)
+	{
+		const Vector2d point = Vector2d::Random();
+		vector<double> expected;
+		for (size_t j = 0; j < points.size(); ++j)
+			if (live[j])
+				expected.push_back((points[j] - point).squaredNorm());
+		sort(expected.begin(), expected.end());
+
+		ASSERT_EQ(min<size_t>(5, expected.size()), tree.knn(point, 5,
+			neighbours));
+		for (size_t j = 0; j < neighbours.size(); ++j)
+			ASSERT_EQ(expected[j], neighbours[j].distanceSquared);
+	}
+}
+
+TEST(SpatialTreeTest, 2d_bucket_sizes)
+{
+	randomEdits<1>();
+	randomEdits<3>();
+	randomEdits<16>();
+}
@@ -0,0 +1,80 @@
+//
+// Created on 10/17/2026.
+//
+
+#include <math/Trig.hpp>
+#include <math/geometry/ReferenceFrame.hpp>
+#include "gtest/gtest.h"
+
+#define TEST_COUNT 100000
+
+using namespace std;
+using namespace flabs;
+using namespace Eigen;
+
+TEST(TrigTest, fast_sincos)
+{
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		double angle = (i - TEST_COUNT / 2) * 1e-3;
+		double s, c;
+		FastTrig::sincos(angle, s, c);
+		ASSERT_NEAR(sin(angle), s, 1e-10);
+		ASSERT_NEAR(cos(angle), c, 1e-10);
+
+		float sf, cf;
+		FastTrig::sincos(float(angle), sf, cf);
+		ASSERT_NEAR(sin(float(angle)), sf, 1e-5);
+		ASSERT_NEAR(cos(float(angle)), cf, 1e-5);
+	}
+}
+
+TEST(TrigTest, fast_atan2)
+{
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		double angle = (i - TEST_COUNT / 2) * (M_PI / (TEST_COUNT / 2));
+		double r     = 1 + i % 7;
+		ASSERT_NEAR(atan2(r * sin(angle), r * cos(angle)),
+			FastTrig::atan2(r * sin(angle), r * cos(angle)), 5e-8);
+	}
+	ASSERT_EQ(0, FastTrig::atan2(0., 0.));
+	ASSERT_NEAR(M_PI / 2, FastTrig::atan2(1., 0.), 5e-8);
+	ASSERT_NEAR(M_PI, FastTrig::atan2(0., -1.), 5e-8);
+}
+
+TEST(TrigTest, batch_matches_scalar)
+{
+	ArrayXd angles = ArrayXd::Random(TEST_COUNT) * 100;
+	ArrayXd s, c;
+	FastTrig::sincos(angles, s, c);
+	ArrayXd a = FastTrig::atan2(s, c);
+	for (int i = 0; i < TEST_COUNT; ++i)
+	{
+		double si, ci;
+		FastTrig::sincos(angles(i), si, ci);
+		ASSERT_NEAR(si, s(i), 1e-14);
+		ASSERT_NEAR(ci, c(i), 1e-14);
+		ASSERT_NEAR(FastTrig::atan2(si, ci), a(i), 1e-14);
+	}
+
+	ArrayXd es, ec;
+	ExactTrig::sincos(angles, es, ec);
+	ASSERT_TRUE(es.isApprox(angles.sin()));
+	ASSERT_TRUE(ExactTrig::atan2(es, ec).isApprox(FastTrig::atan2(s, c), 1e-7));
+}
+
+TEST(TrigTest, fast_reference_frame)
+{
+	FastRigidReferenceFrame2d fast(1, 2, 3);
+	RigidReferenceFrame2d     exact(1, 2, 3);
+	ASSERT_TRUE(fast.transformationMatrix.matrix().isApprox(
+		exact.transformationMatrix.matrix(), 1e-10));
+	ASSERT_NEAR(exact.getYawOffset(), fast.getYawOffset(), 5e-8);
+
+	double x, y, yaw;
+	fast.getXYYaw(x, y, yaw);
+	ASSERT_EQ(1, x);
+	ASSERT_EQ(2, y);
+	ASSERT_NEAR(3, yaw, 5e-8);
+}